@@ -8,13 +8,16 @@
  *   - Only cfg struct needs freeing with inimini_free()
  *   - ENV vars ($HOME, $PROGRAMDATA) must be set by caller for paths
  *   - Flags as bitmask: flags = IMI_COMMENT | IMI_GITSTYLE;
+ *   - Compiles as C or C++; inimini.hpp adds an optional C++17 RAII wrapper
+ *   - A live cfg is single-threaded: even getint/getdbl/getbool/getarr fill per-entry caches, so
+ *     share it across threads through inimini_freeze() or a reload handle
  *
  * ============================================================================
  * USAGE
  * ============================================================================
  *
  * Lifecycle:
- *   inimini_t *cfg = inimini_new();
+ *   inimini_t *cfg = inimini_new();       // or inimini_new_arena(0) for load-and-read configs
  *
  *   if (!inimini_load(cfg, "myapp", IMI_INISTYLE)) exit(1);
  *
@@ -22,13 +25,15 @@
  *   const char *url     = inimini_getstr(cfg, "server.url", "http://localhost");
  *   int timeout         = inimini_getint(cfg, "network.timeout") default;
  *   double ratio        = inimini_getdbl(cfg, "mix.amount", default);
- *   char **plugins      = inimini_getarr(cfg, "plugins.enabled", default);
+ *   const char **plugins = inimini_getarr(cfg, "plugins.enabled", default);
  *   bool is_daemon      = inimini_hasval(cfg, "core.daemonize", "true");
  *
  *   inimini_free(cfg);
  *
  * Edit Config:
  *   inimini_read(cfg, "myapp.conf", IMI_KEEPVARS | IMI_COMMENTS);
+ *   inimini_parse_buf(cfg, buf, len, IMI_COMMENTS);   // same scanner, config already in memory
+ *   inimini_read_dir(cfg, "/etc/myapp/conf.d", 0);     // *.conf fragments, parallel parse, lexical merge
  *
  *   inimini_setstr(cfg, "debug.mode", "true");
  *   inimini_setint(cfg, "debug.level", 1);
@@ -39,9 +44,22 @@
  *
  *   inimini_write(cfg, "./myapp.conf", IMI_KEEPVARS | IMI_COMMENTS);
  *
+ * Hot Keys:
+ *   imi_handle_t limit = inimini_handle(cfg, "rate.limit");
+ *   double rate        = inimini_hgetdbl(limit, 1.0);
+ *
+ * Thread-Safe Reads:
+ *   inimini_frozen_t *snap = inimini_freeze(cfg);
+ *   int workers = inimini_frozen_getint(snap, "core.workers", 4);
+ *   inimini_frozen_free(snap);
+ *
+ * Walk Keys (no allocation):
+ *   imi_iter_t it;
+ *   for (inimini_iter_prefix(cfg, "server", &it); inimini_iter_next(&it); ) puts(it.key);
+ *
  * List Keys:
- *   const char **sections = inimini_getsub(cfg, "", cnt);
- *   const char **keys = inimini_getsub(cfg, "section", cnt);
+ *   const char **sections = inimini_getsub(cfg, "", &cnt);        // free(sections) only, strings are borrowed
+ *   const char **keys = inimini_getsub(cfg, "section", &cnt);
  *
  * ========================================================================== */
 
@@ -55,7 +73,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 #include <unistd.h>
+#include <sys/stat.h>
+
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <fnmatch.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -76,6 +109,41 @@ extern "C" {
 #define IMI_KEEPVARS      0x0004      /* Preserve ${VAR} literals on read/write */
 #define IMI_COMMENTS      0x0008      /* Preserve comments inline or trailing */
 
+// Load flags
+#define IMI_PARALLEL      0x0010      /* inimini_load: resolve and parse the three layers concurrently */
+#define IMI_INCLUDES      0x0020      /* Follow [include] / [includeIf "gitdir:..."] path = ... directives */
+#define IMI_UPSERT        0x0040      /* Parse: a repeated key replaces the earlier entry in place */
+#define IMI_MMAP          0x0080      /* Parse: map files copy-on-write instead of reading them */
+
+// Entry conversion cache bits (imi_entry_t.typed)
+#define IMI_TYPED_INT     0x0001      /* ival holds strtoll(value) */
+#define IMI_TYPED_DBL     0x0002      /* dval holds strtod(value) */
+#define IMI_TYPED_BOOL    0x0004      /* bval holds the boolean reading of value */
+#define IMI_TYPED_EINT    0x0010      /* value is not a complete base-10 integer */
+#define IMI_TYPED_RINT    0x0020      /* integer out of int64 range (ival clamped) */
+#define IMI_TYPED_EDBL    0x0040      /* value is not a complete double */
+#define IMI_TYPED_RDBL    0x0080      /* double out of range */
+#define IMI_TYPED_EBOOL   0x0100      /* value is not true/false/yes/no/on/off/1/0 */
+
+// Diff record bits (imi_change_t.what)
+#define IMI_DIFF_ADDED    0x0001      /* Key only in b */
+#define IMI_DIFF_REMOVED  0x0002      /* Key only in a */
+#define IMI_DIFF_VALUE    0x0004      /* Value differs */
+#define IMI_DIFF_COMMENT  0x0008      /* Comment differs (IMI_COMMENTS only) */
+
+// Struct binding field types (imi_bind_t.type)
+#define IMI_BIND_STR      0x0001      /* const char * borrowed from cfg (or the default literal) */
+#define IMI_BIND_INT      0x0002      /* int, clamped to INT_MIN..INT_MAX */
+#define IMI_BIND_I64      0x0003      /* int64_t */
+#define IMI_BIND_DBL      0x0004      /* double */
+#define IMI_BIND_BOOL     0x0005      /* int 0/1 */
+
+// Checked getter status codes
+#define IMI_OK            0           /* Converted cleanly */
+#define IMI_ENOKEY        -1          /* Key not found (out untouched) */
+#define IMI_EINVAL        -2          /* Value is not of the requested type (out untouched) */
+#define IMI_ERANGE        -3          /* Value out of range (out clamped) */
+
 /* Default depth for subsection splitting (compilable time constant) */
 #ifndef IMI_DOTDEPTH
 #define IMI_DOTDEPTH     2
@@ -96,20 +164,47 @@ extern "C" {
 #define IMI_KEY_LEN      1024
 #endif
 
+/* Maximum [include] nesting */
+#ifndef IMI_INCLUDE_DEPTH
+#define IMI_INCLUDE_DEPTH 10
+#endif
+
 /* Default section length */
 #ifndef IMI_SECTION_LEN
 #define IMI_SECTION_LEN   256
 #endif
 
+/* Default accumulated comment length */
+#ifndef IMI_COMMENT_LEN
+#define IMI_COMMENT_LEN  1024
+#endif
+
+/* Default arena chunk size for inimini_new_arena() */
+#ifndef IMI_ARENA_CHUNK
+#define IMI_ARENA_CHUNK   65536
+#endif
+
+/* Seeds tried per bucket before inimini_schema_new gives up */
+#ifndef IMI_SCHEMA_TRIES
+#define IMI_SCHEMA_TRIES  65536
+#endif
+
+/* Keys probed together by the inimini_getmany family */
+#ifndef IMI_BATCH
+#define IMI_BATCH         16
+#endif
+
 /* ============================================================================
  * CORE TYPES
- * MEMORY MODEL: Linked list (no realloc brittleness). Each entry malloc'd independently.
+ * MEMORY MODEL: Linked list (no realloc brittleness). Each entry malloc'd independently (or arena).
  * COMMENTS: Single field per entry. Section comments concatenated on merge, entry comments overwritten.
  * PARENT TRACKING: Implied from key structure at read time ("vext.url" -> parent="vext").
  * TWO-PASS DESIGN: Parent resolution happens on read. Write uses pre-built structure.
  * STACK ORDER (later wins): /etc/{prog}/{prog}.conf → ~/.config/{prog}.conf → ~/.{prog}conf → ./.{prog}conf
  * PATH RESOLUTION: Caller sets ENV vars ($HOME, $PROGRAMDATA, etc.). Lib resolves ${VAR} strings.
  * ANDROID/IOS: Sandbox paths exposed via custom ENV variables set by host application.
+ * ARENA MODE: inimini_new_arena() bump-allocates nodes and strings in chunks, released at once.
+ * ZERO-COPY: Files are read (or with IMI_MMAP mapped) into blocks owned by cfg, values are views.
  * ========================================================================== */
 typedef struct imi_entry {
 	char   *key;             /* Flat key: "section.sub.key" */
@@ -117,15 +212,393 @@ typedef struct imi_entry {
 	char   *comment;         /* Single comment field (concatenated for sections on merge) */
 	char   *parent;          /* Computed parent section ("vext"), "" if no section */
 	char   **parsed;         /* when returned as an array stored here */
+	uint64_t hash;           /* Cached index hash (key, or seeded parent for section markers) */
+	int64_t  ival;           /* Cached integer conversion of value */
+	double   dval;           /* Cached double conversion of value */
+	int      bval;           /* Cached boolean reading of value */
+	uint32_t typed;          /* Cached conversions and their status (IMI_TYPED_*), reset on value change */
+	struct imi_node  *sect;  /* Section tree node of parent (NULL = not indexed) */
+	struct imi_entry *snext; /* Next keyed entry in the same section */
+	struct imi_entry *sprev; /* Previous keyed entry in the same section */
 	struct imi_entry *next;  /* Linked list node */
 } imi_entry_t;
 
+/* Stable reference to an entry: survives value updates, invalidated by remove/clear/free */
+typedef imi_entry_t *imi_handle_t;
+
+/* ARENA: Chunk list for bump allocation, newest chunk first. The payload follows the header
+ * (no flexible array member, so the header also compiles as C++). */
+typedef struct imi_chunk {
+	struct imi_chunk *next;  /* Previously filled chunk */
+	size_t size;             /* Usable payload bytes */
+	size_t used;             /* Bytes handed out so far */
+} imi_chunk_t;
+
+/* BLOCK: Source buffer parsed values point straight into. Kept while any entry still holds a
+ * view into it, so values replaced by later reads don't pin their old source. */
+typedef struct imi_block {
+	struct imi_block *next;  /* Previously parsed block */
+	char   *data;            /* Private mapping or heap copy, NUL-terminated lines after parse */
+	size_t size;             /* Source bytes (data holds size + 1) */
+	int    mapped;           /* 1 = munmap on release, 0 = free */
+	int    busy;             /* Being parsed, kept even with no views yet */
+	size_t views;            /* Entry values and comments pointing into data */
+} imi_block_t;
+
+/* STAMP: File identity and state, compared to tell whether a parsed file is still current */
+typedef struct {
+	uint64_t path;   /* __imi_hash of the file path, 0 = file absent */
+	uint64_t size;   /* st_size */
+	uint64_t mtime;  /* Modification time in ns */
+	uint64_t ino;    /* st_ino */
+} imi_stamp_t;
+
+/* SOURCE: Outside state a parse depended on - included files for watchers (zero stamp = missing),
+ * and with them the variables it expanded and the repository includeIf matched against, so
+ * caches of the result can tell when it went stale */
+#define __IMI_SRC_FILE   'f'  /* Included file, stamp as taken before parsing it */
+#define __IMI_SRC_ENV    'e'  /* Environment variable, stamp.path = value hash | 1 (0 = unset) */
+#define __IMI_SRC_GIT    'g'  /* Repository enclosing cwd (includeIf), stamp.path = .git path hash */
+
+typedef struct imi_source {
+	struct imi_source *next; /* Previously recorded source */
+	char   *path;            /* Canonical path or variable name (heap) */
+	int    kind;             /* __IMI_SRC_* */
+	imi_stamp_t stamp;       /* State its entries were parsed from (zero = unreadable) */
+} imi_source_t;
+
+/* SUBSCRIPTIONS: Byte trie over key prefixes. A change to key walks the trie along the key and
+ * calls the subscribers parked on every node it passes, so dispatch costs the key length plus
+ * the matching subscribers, however many others are registered. */
+typedef void (*imi_sub_fn)(const char *key, const char *value, void *ctx);  /* value NULL = removed */
+
+typedef struct imi_sub {
+	struct imi_sub *next;       /* Next subscriber on the same prefix */
+	imi_sub_fn  fn;             /* Callback */
+	void        *ctx;           /* Callback context */
+} imi_sub_t;
+
+typedef struct imi_subnode {
+	struct imi_subnode *child;   /* First child */
+	struct imi_subnode *sibling; /* Next child of the same node */
+	imi_sub_t   *subs;           /* Subscribers whose prefix ends here */
+	unsigned char c;             /* Edge byte from the parent */
+} imi_subnode_t;
+
+/* INDEX: Open-addressing hash table over keys and section markers. The list stays authoritative
+ * (and ordered for write), the index only points at the first entry of each key so lookups keep
+ * list semantics. */
+typedef struct {
+	uint64_t    hash;    /* Key hash, kept here so probes and growth never touch entries */
+	imi_entry_t *entry;  /* NULL = empty, __IMI_TOMB = removed */
+} imi_slot_t;
+
+/* SECTION TREE: One node per dotted parent prefix ("a", "a.b"), found by path hash. Each node
+ * links the keyed entries whose parent is its path, so section listings walk only the output. */
+typedef struct imi_node {
+	char   *path;             /* Full dotted path, heap owned */
+	uint64_t hash;            /* __imi_hash(path) */
+	struct imi_node *chain;   /* Next node in the same hash bucket */
+	struct imi_node *up;      /* Parent prefix node (NULL at top level) */
+	struct imi_node *child;   /* First child node */
+	struct imi_node *ctail;   /* Last child node, children keep order of appearance */
+	struct imi_node *sibling; /* Next child of up */
+	struct imi_node *lnext;   /* Next live section, in order of appearance */
+	struct imi_node *lprev;   /* Previous live section */
+	imi_entry_t *first;       /* First keyed entry with parent == path */
+	imi_entry_t *last;        /* Last keyed entry with parent == path */
+	size_t refs;              /* Entries and markers with parent == path (0 = prefix only) */
+	size_t keys;              /* Keyed entries in this subtree */
+} imi_node_t;
+
+/* SCHEMA: Perfect hash over a fixed key list. A key hashes (__imi_hash) to a bucket, the bucket
+ * seed displaces it to a slot no other schema key uses, so one probe finds its index. */
+typedef struct {
+	const char *const *keys; /* Borrowed key list, position = schema id */
+	size_t   n;              /* Key count */
+	size_t   mask;           /* Slot count - 1 */
+	size_t   bmask;          /* Bucket count - 1 */
+	uint64_t *hashes;        /* __imi_hash of each key, by id */
+	uint32_t *seeds;         /* Displacement seed per bucket */
+	int32_t  *slots;         /* Slot -> id, -1 = empty */
+} imi_schema_t;
+
 typedef struct {
-	imi_entry_t *head;  /* First entry in config linked list */
-	imi_entry_t *tail;  /* Last entry in config linked list */
-	size_t      count;  /* Total number of entries traversable */
+	imi_entry_t *head;   /* First entry in config linked list */
+	imi_entry_t *tail;   /* Last entry in config linked list */
+	size_t      count;   /* Total number of entries traversable */
+	imi_slot_t  *slots;  /* Key index slots (empty, tombstone or first entry of a key) */
+	size_t      cap;     /* Index capacity, power of two (0 = no index, lookups walk the list) */
+	size_t      used;    /* Index slots occupied, tombstones included */
+	imi_chunk_t *arena;  /* Arena chunks (arena mode only) */
+	size_t      chunk;   /* Arena chunk size (0 = heap mode, every string malloc'd) */
+	imi_block_t *blocks; /* Source buffers backing value views */
+	imi_source_t *sources; /* Files included while parsing, newest first */
+	imi_subnode_t *subs; /* Change subscription trie (NULL = no subscribers) */
+	imi_node_t  **tree;  /* Section tree buckets, power of two */
+	size_t      tcap;    /* Section tree bucket count */
+	size_t      nodes;   /* Section tree nodes, prefix-only nodes included */
+	imi_node_t  *secs;   /* First live section (refs > 0) */
+	imi_node_t  *stail;  /* Last live section */
+	size_t      nsecs;   /* Live sections */
+	const imi_schema_t *schema; /* Attached key schema (borrowed, NULL = none) */
+	imi_entry_t **fixed; /* Indexed entry per schema id, NULL = key absent */
 } inimini_t;
 
+/* ============================================================================
+ * ALLOCATION (HEAP OR ARENA)
+ * Everything owned by an entry goes through these so inimini_new_arena() can swap
+ * per-string malloc/free for bump allocation. Releases are no-ops in arena mode.
+ * ========================================================================== */
+#define __IMI_ALIGN 16
+
+static inline void *__imi_alloc(inimini_t *cfg, size_t size) {
+	if (!cfg->chunk) return calloc(1, size);
+
+	size = (size + __IMI_ALIGN - 1) & ~(size_t)(__IMI_ALIGN - 1);
+
+	imi_chunk_t *c = cfg->arena;
+
+	if (!c || c->size - c->used < size) {
+		size_t csize = size > cfg->chunk ? size : cfg->chunk;
+
+		c = (imi_chunk_t *)malloc(sizeof(imi_chunk_t) + csize);
+
+		if (!c) return NULL;
+
+		c->size = csize;
+		c->used = 0;
+
+		/* Keep filling the current chunk if an oversized request got its own */
+		if (cfg->arena && csize > cfg->chunk) {
+			c->next = cfg->arena->next;
+			cfg->arena->next = c;
+		} else {
+			c->next = cfg->arena;
+			cfg->arena = c;
+		}
+	}
+
+	void *p = (unsigned char *)(c + 1) + c->used;
+
+	c->used += size;
+
+	return memset(p, 0, size);
+}
+
+static inline char *__imi_strndup(inimini_t *cfg, const char *s, size_t len) {
+	char *p = cfg->chunk ? (char *)__imi_alloc(cfg, len + 1) : (char *)malloc(len + 1);
+
+	if (!p) return NULL;
+
+	memcpy(p, s, len);
+
+	p[len] = '\0';
+
+	return p;
+}
+
+static inline char *__imi_strdup(inimini_t *cfg, const char *s) {
+	return __imi_strndup(cfg, s, strlen(s));
+}
+
+static inline imi_block_t *__imi_block_of(const inimini_t *cfg, const void *p) {
+	for (imi_block_t *b = cfg->blocks; b; b = b->next) {
+		if ((uintptr_t)p >= (uintptr_t)b->data && (uintptr_t)p <= (uintptr_t)b->data + b->size) return b;
+	}
+
+	return NULL;
+}
+
+static inline void __imi_block_drop(inimini_t *cfg, imi_block_t *b);
+
+/* An entry took p: count it if it is a view into a block */
+static inline void __imi_view(inimini_t *cfg, const void *p) {
+	imi_block_t *b = p ? __imi_block_of(cfg, p) : NULL;
+
+	if (b) b->views++;
+}
+
+/* An entry let go of p: free owned strings, drop blocks once their last view is gone */
+static inline void __imi_release(inimini_t *cfg, void *p) {
+	if (!p) return;
+
+	imi_block_t *b = __imi_block_of(cfg, p);
+
+	if (b) {
+		if (!--b->views && !b->busy) __imi_block_drop(cfg, b);
+	} else if (!cfg->chunk) {
+		free(p);
+	}
+}
+
+static inline void __imi_arena_free(inimini_t *cfg) {
+	while (cfg->arena) {
+		imi_chunk_t *next = cfg->arena->next;
+
+		free(cfg->arena);
+
+		cfg->arena = next;
+	}
+}
+
+/* ============================================================================
+ * SOURCE BLOCKS
+ * The parser works in place: each line is NUL-terminated inside the block and values that need
+ * no expansion are stored as pointers into it. Blocks are heap copies of the file. IMI_MMAP maps
+ * them copy-on-write instead, which saves the read for short-lived configs only: every page with
+ * a newline gets copied by the terminators anyway, and the pages that don't still follow the
+ * file - they change when it is rewritten in place and SIGBUS once it is truncated.
+ * ========================================================================== */
+static inline imi_block_t *__imi_block_push(inimini_t *cfg, char *data, size_t size, int mapped) {
+	imi_block_t *b = (imi_block_t *)malloc(sizeof(imi_block_t));
+
+	if (!b) return NULL;
+
+	b->data = data;
+	b->size = size;
+	b->mapped = mapped;
+	b->busy = 0;
+	b->views = 0;
+	b->next = cfg->blocks;
+
+	cfg->blocks = b;
+
+	return b;
+}
+
+static inline imi_block_t *__imi_block_file(inimini_t *cfg, FILE *f, uint32_t flags) {
+	struct stat st;
+
+	if (fstat(fileno(f), &st)) return NULL;
+
+#if !defined(_WIN32)
+	long page = sysconf(_SC_PAGESIZE);
+
+	/* Map when the page tail has room for the final terminator, otherwise slurp below */
+	if ((flags & IMI_MMAP) && S_ISREG(st.st_mode) && st.st_size > 0 && page > 0 && st.st_size % page) {
+		void *m = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(f), 0);
+
+		if (m != MAP_FAILED) {
+			imi_block_t *b = __imi_block_push(cfg, (char *)m, st.st_size, 1);
+
+			if (!b) munmap(m, st.st_size);
+
+			return b;
+		}
+	}
+#endif
+
+	size_t cap = S_ISREG(st.st_mode) && st.st_size > 0 ? (size_t)st.st_size + 1 : 4096;
+	size_t len = 0;
+	char *data = (char *)malloc(cap);
+
+	while (data) {
+		len += fread(data + len, 1, cap - len - 1, f);
+
+		if (len < cap - 1) break;
+
+		char *tmp = (char *)realloc(data, cap * 2);
+
+		if (!tmp) free(data);
+
+		data = tmp;
+		cap *= 2;
+	}
+
+	if (!data) return NULL;
+
+	imi_block_t *b = __imi_block_push(cfg, data, len, 0);
+
+	if (!b) free(data);
+
+	return b;
+}
+
+static inline void __imi_block_unmap(imi_block_t *b) {
+#if !defined(_WIN32)
+	if (b->mapped) munmap(b->data, b->size);
+	else free(b->data);
+#else
+	free(b->data);
+#endif
+
+	free(b);
+}
+
+static inline void __imi_block_drop(inimini_t *cfg, imi_block_t *b) {
+	imi_block_t **pp = &cfg->blocks;
+
+	while (*pp && *pp != b) pp = &(*pp)->next;
+
+	if (*pp) *pp = b->next;
+
+	__imi_block_unmap(b);
+}
+
+static inline void __imi_blocks_free(inimini_t *cfg) {
+	while (cfg->blocks) {
+		imi_block_t *next = cfg->blocks->next;
+
+		__imi_block_unmap(cfg->blocks);
+
+		cfg->blocks = next;
+	}
+}
+
+static inline void __imi_sources_free(inimini_t *cfg) {
+	while (cfg->sources) {
+		imi_source_t *next = cfg->sources->next;
+
+		free(cfg->sources->path);
+		free(cfg->sources);
+
+		cfg->sources = next;
+	}
+}
+
+/* Remember a source once, with the state first seen (best effort) */
+static inline void __imi_source_add(inimini_t *cfg, int kind, const char *path, const imi_stamp_t *stamp) {
+	for (const imi_source_t *o = cfg->sources; o; o = o->next) {
+		if (o->kind == kind && !strcmp(o->path, path)) return;
+	}
+
+	imi_source_t *src = (imi_source_t *)calloc(1, sizeof(imi_source_t));
+
+	if (!src) return;
+
+	src->kind = kind;
+
+	if (stamp) src->stamp = *stamp;
+
+	if (!(src->path = strdup(path))) {
+		free(src);
+
+		return;
+	}
+
+	src->next = cfg->sources;
+	cfg->sources = src;
+}
+
+static inline uint64_t __imi_hash(const char *s);
+
+static inline void __imi_env_stamp(const char *value, imi_stamp_t *s) {
+	memset(s, 0, sizeof(*s));
+
+	if (value) s->path = __imi_hash(value) | 1;
+}
+
+static inline const char *__imi_getenv(inimini_t *cfg, const char *name) {
+	const char *value = getenv(name);
+	imi_stamp_t st;
+
+	__imi_env_stamp(value, &st);
+	__imi_source_add(cfg, __IMI_SRC_ENV, name, &st);
+
+	return value;
+}
+
 /* ============================================================================
  * PRIVATE HELPER FUNCTIONS
  * ========================================================================== */
@@ -143,12 +616,12 @@ static inline char *__imi_trim(char *s) {
 	return s;
 }
 
-static inline char *__imi_expand_env(const char *in) {
-	if (!in) return strdup("");
+static inline char *__imi_expand_env(inimini_t *cfg, const char *in) {
+	if (!in) return __imi_strdup(cfg, "");
 
 	const char *start = strstr(in, "${");
 
-	if (!start) return strdup(in);
+	if (!start) return __imi_strdup(cfg, in);
 
 	char res[8192];
 	size_t pos = 0;
@@ -178,7 +651,7 @@ static inline char *__imi_expand_env(const char *in) {
 
 		strncpy(var_name, var_start, var_len);
 
-		char *val = getenv(var_name);
+		const char *val = __imi_getenv(cfg, var_name);
 
 		if (val) {
 			size_t val_len = strlen(val);
@@ -193,7 +666,7 @@ static inline char *__imi_expand_env(const char *in) {
 		cursor = var_end + 1;
 	}
 
-	if (pos == 0) return strdup(in);
+	if (pos == 0) return __imi_strdup(cfg, in);
 
 	if (*cursor) {
 		size_t remaining = strlen(cursor);
@@ -207,7 +680,7 @@ static inline char *__imi_expand_env(const char *in) {
 
 	res[pos] = '\0';
 
-	return strdup(res);
+	return __imi_strndup(cfg, res, pos);
 }
 
 static inline void __imi_free_array(char **arr, size_t count) {
@@ -218,771 +691,4296 @@ static inline void __imi_free_array(char **arr, size_t count) {
 	free(arr);
 }
 
-static inline char *__imi_extract_parent(const char *key) {
-	if (!key) return strdup("");
+static inline char *__imi_extract_parent(inimini_t *cfg, const char *key) {
+	if (!key) return __imi_strdup(cfg, "");
 
 	const char *dot = strrchr(key, '.');
 
-	if (!dot) return strdup(key);
+	if (!dot) return __imi_strdup(cfg, key);
 
 	size_t len = dot - key;
 
-	if (len == 0) return strdup(IMI_DEFAULT);
-
-	char *parent = malloc(len + 1);
-
-	if (!parent) return strdup("");
+	if (len == 0) return __imi_strdup(cfg, IMI_DEFAULT);
 
-	strncpy(parent, key, len);
-
-	parent[len] = '\0';
-
-	return parent;
+	return __imi_strndup(cfg, key, len);
 }
 
-static inline char *__imi_extract_key(const char *key) {
-	if (strchr(key, '.') != NULL) return strdup(key);
+static inline char *__imi_extract_key(inimini_t *cfg, const char *key) {
+	if (strchr(key, '.') != NULL) return __imi_strdup(cfg, key);
 
-	size_t tlen = strlen(IMI_DEFAULT);
-	size_t klen = strlen(key);
-	char   res[IMI_KEY_LEN];
+	char res[IMI_KEY_LEN];
 
 	snprintf(res, IMI_KEY_LEN, "%s.%s", IMI_DEFAULT, key);
 
-	return strdup(res);
+	return __imi_strdup(cfg, res);
 }
 
-static inline void __imi_list_append(inimini_t *cfg, imi_entry_t *entry) {
-	if (!entry) return;
-
-	entry->next = NULL;
-
-	if (!cfg->head) {
-		cfg->head = cfg->tail = entry;
-	} else {
-		cfg->tail->next = entry;
-		cfg->tail = entry;
-	}
+/* Replace an entry value, dropping everything derived from the old one */
+static inline void __imi_set_value(inimini_t *cfg, imi_entry_t *e, const char *val) {
+	__imi_release(cfg, e->value);
+	free(e->parsed);
 
-	cfg->count++;
+	e->value = val ? __imi_strdup(cfg, val) : NULL;
+	e->parsed = NULL;
+	e->typed = 0;
 }
 
-static inline imi_entry_t *__imi_find_entry(inimini_t *cfg, const char *key) {
-	for (imi_entry_t *e = cfg->head; e; e = e->next) {
-		if (!strcmp(e->key, key)) return e;
-	}
+static inline void __imi_free_entry(inimini_t *cfg, imi_entry_t *e) {
+	free(e->parsed);
 
-	return NULL;
+	if (cfg->chunk) return;
+
+	free(e->key);
+	__imi_release(cfg, e->value);
+	__imi_release(cfg, e->comment);
+	free(e->parent);
+	free(e);
 }
 
 /* ============================================================================
- * OBJECT LIFECYCLE
+ * KEY INDEX
  * ========================================================================== */
-static inline inimini_t *inimini_new(void) {
-	inimini_t *cfg = calloc(1, sizeof(inimini_t));
-
-	return cfg;
-}
-
-static inline void inimini_free(inimini_t *cfg) {
-	if (!cfg) return;
+static imi_entry_t __imi_tombstone;
 
-	imi_entry_t *e = cfg->head;
+#define __IMI_TOMB (&__imi_tombstone)
 
-	while (e) {
-		imi_entry_t *next = e->next;
+/* Section markers (key == NULL) are indexed by parent under a separate hash space */
+#define __IMI_SECTION_SEED 0x9e3779b97f4a7c15ULL
 
-		free(e->key);
-		free(e->value);
-		free(e->parsed);
-		free(e->comment);
-		free(e->parent);
-		free(e);
+/* FNV-1a 64 - cheap, stable across platforms and trivially constexpr for wrappers */
+static inline uint64_t __imi_hash(const char *s) {
+	uint64_t h = 0xcbf29ce484222325ULL;
 
-		e = next;
+	while (*s) {
+		h ^= (unsigned char)*s++;
+		h *= 0x100000001b3ULL;
 	}
 
-	free(cfg);
+	return h;
 }
 
-/* ============================================================================
- * PARSER OPERATIONS
- * ========================================================================== */
-static inline void __imi_create_section(inimini_t *cfg, const char *name, const char *comment) {
-	imi_entry_t *e = calloc(1, sizeof(imi_entry_t));
-	e->key = NULL;
-	e->parent = strdup(name);
-	e->comment = comment ? strdup(comment) : NULL;
+static inline int __imi_index_match(const imi_entry_t *e, const char *name, int marker) {
+	if (marker) return !e->key && !strcmp(e->parent, name);
 
-	__imi_list_append(cfg, e);
+	return e->key && !strcmp(e->key, name);
 }
 
-static inline void __imi_parse_comment(char *line, char *buf) {
-	line = __imi_trim(line + 1);
+static inline imi_entry_t *__imi_index_find(const inimini_t *cfg, const char *name, uint64_t hash, int marker) {
+	size_t mask = cfg->cap - 1;
+
+	for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+		const imi_slot_t *s = &cfg->slots[i];
 
-	if (strlen(buf)) strcat(buf, "\n");
+		if (!s->entry) return NULL;
 
-	strcat(buf, line);
+		if (s->hash == hash && s->entry != __IMI_TOMB && __imi_index_match(s->entry, name, marker)) return s->entry;
+	}
 }
 
-static inline int __imi_parse_section(const char *line, char *section) {
-	const char *start, *end;
-	size_t slen;
-	char name[IMI_SECTION_LEN] = {0};
+/* Insert unless the key is already indexed - the first entry in list order always wins */
+static inline void __imi_index_insert(inimini_t *cfg, imi_entry_t *entry) {
+	size_t mask = cfg->cap - 1;
+	size_t tomb = SIZE_MAX;
 
-	start = line + 1;
-	end = strchr(start, ']');
+	for (size_t i = entry->hash & mask; ; i = (i + 1) & mask) {
+		imi_slot_t *s = &cfg->slots[i];
 
-	if (!start || !end) return 0;
+		if (!s->entry) {
+			if (tomb != SIZE_MAX) {
+				s = &cfg->slots[tomb];
+			} else {
+				cfg->used++;
+			}
 
-	slen = end - start;
+			s->hash = entry->hash;
+			s->entry = entry;
 
-	strncpy(name, start, slen);
+			return;
+		}
 
-	name[slen] = '\0';
+		if (s->entry == __IMI_TOMB) {
+			if (tomb == SIZE_MAX) tomb = i;
+		} else if (s->hash == entry->hash && __imi_index_match(s->entry, entry->key ? entry->key : entry->parent, !entry->key)) {
+			return;
+		}
+	}
+}
 
-	__imi_trim(name);
-	strcpy(section, name);
+/* Grow (or clean tombstones) by rehashing live slots - keys are unique there and hashes are
+ * kept in the slots, so entries are never touched. Without a live index it is rebuilt from
+ * the list. On allocation failure the index is dropped and lookups fall back to walking the
+ * list until the next successful rebuild. */
+static inline void __imi_index_rebuild(inimini_t *cfg) {
+	size_t cap = 16;
 
-	return 1;
-}
+	while (cap < cfg->count * 2) cap <<= 1;
 
-static inline void __imi_parse_key_value(inimini_t *cfg, const char *line, const char *section, char *comment, uint32_t flags) {
-	char *eq = strchr(line, '=');
+	imi_slot_t *slots = (imi_slot_t *)calloc(cap, sizeof(imi_slot_t));
+	imi_slot_t *old = cfg->slots;
+	size_t old_cap = cfg->cap;
 
-	if (!eq) return;
+	cfg->slots = slots;
+	cfg->cap = slots ? cap : 0;
+	cfg->used = 0;
 
-	*eq++ = '\0';
+	if (slots && old_cap) {
+		for (size_t i = 0; i < old_cap; i++) {
+			if (!old[i].entry || old[i].entry == __IMI_TOMB) continue;
 
-	char *key = __imi_trim(strdup(line));
-	char *val = __imi_trim(strdup(eq));
-	size_t vlen = strlen(val);
+			size_t j = old[i].hash & (cap - 1);
 
-	if (vlen >= 2 && val[0] == '"' && val[vlen - 1] == '"') {
-		val[vlen - 1] = '\0';
-		val++;
+			while (slots[j].entry) j = (j + 1) & (cap - 1);
+
+			slots[j] = old[i];
+			cfg->used++;
+		}
+	} else if (slots) {
+		for (imi_entry_t *e = cfg->head; e; e = e->next) {
+			if (e->key || e->parent) __imi_index_insert(cfg, e);
+		}
 	}
 
-	char *trailing_com = strchr(val, ';');
+	free(old);
+}
 
-	if ((flags & IMI_COMMENTS) && trailing_com) {
-		*trailing_com = '\0';
-		val = __imi_trim(val);
-		trailing_com = __imi_trim(trailing_com + 1);
+static inline uint64_t __imi_schema_mix(uint64_t h, uint32_t seed) {
+	h ^= seed * 0x9e3779b97f4a7c15ULL;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
 
-		if (strlen(comment)) strcat(comment, "\n");
+	return h;
+}
 
-		strcat(comment, trailing_com);
-	} else {
-		trailing_com = strchr(val, '#');
+/* Schema id of key (hash == __imi_hash(key)), -1 when the key is not in the schema */
+static inline int __imi_schema_find(const imi_schema_t *s, const char *key, uint64_t hash) {
+	int32_t id = s->slots[__imi_schema_mix(hash, s->seeds[(hash >> 32) & s->bmask]) & s->mask];
 
-		if ((flags & IMI_COMMENTS) && trailing_com) {
-			*trailing_com = '\0';
-			val = __imi_trim(val);
-			trailing_com = __imi_trim(trailing_com + 1);
+	return id >= 0 && s->hashes[id] == hash && !strcmp(s->keys[id], key) ? id : -1;
+}
 
-			if (strlen(comment)) strcat(comment, "\n");
+/* Schema slots mirror the index: the first entry of a key fills it, removal promotes the next */
+static inline void __imi_schema_add(inimini_t *cfg, imi_entry_t *entry) {
+	int id = __imi_schema_find(cfg->schema, entry->key, entry->hash);
 
-			strcat(comment, trailing_com);
-		}
-	}
+	if (id >= 0 && !cfg->fixed[id]) cfg->fixed[id] = entry;
+}
 
-	char tmpkey[IMI_KEY_LEN];
+static inline void __imi_schema_del(inimini_t *cfg, imi_entry_t *entry) {
+	int id = __imi_schema_find(cfg->schema, entry->key, entry->hash);
 
-	if (section[0]) snprintf(tmpkey, IMI_KEY_LEN, "%s.%s", section, key);
-	else snprintf(tmpkey, IMI_KEY_LEN, "%s", key);
+	if (id < 0 || cfg->fixed[id] != entry) return;
 
-	imi_entry_t *e = calloc(1, sizeof(imi_entry_t));
-	e->key = __imi_extract_key(tmpkey);
-	e->value = strdup(__imi_expand_env(val));
-	e->parent = __imi_extract_parent(e->key);
-	e->comment = comment ? strdup(comment) : NULL;
+	cfg->fixed[id] = NULL;
 
-	free(key);
-	free(val);
+	for (imi_entry_t *e = entry->next; e; e = e->next) {
+		if (e->hash == entry->hash && e->key && !strcmp(e->key, entry->key)) {
+			cfg->fixed[id] = e;
 
-	__imi_list_append(cfg, e);
+			break;
+		}
+	}
 }
 
-static inline int __imi_parse(inimini_t *cfg, FILE *f, uint32_t flags) {
-	char line[4096], section[IMI_SECTION_LEN] = {0}, current_comment[1024] = {0};
+static inline void __imi_index_add(inimini_t *cfg, imi_entry_t *entry) {
+	if (entry->key) entry->hash = __imi_hash(entry->key);
+	else if (entry->parent) entry->hash = __imi_hash(entry->parent) ^ __IMI_SECTION_SEED;
+	else return;
 
-	while (fgets(line, sizeof(line), f)) {
-		char *l = __imi_trim(line);
+	if (cfg->fixed && entry->key) __imi_schema_add(cfg, entry);
 
-		if (!*l) {
-			current_comment[0] = '\0';
+	if (!cfg->cap || (cfg->used + 1) * 4 > cfg->cap * 3) __imi_index_rebuild(cfg);
 
-			continue;
-		}
+	if (cfg->cap) __imi_index_insert(cfg, entry);
+}
 
-		if (*l == ';' || *l == '#') {
-			__imi_parse_comment(l, current_comment);
+/* Drop an entry already unlinked from the list, promoting any later duplicate of its key */
+static inline void __imi_index_del(inimini_t *cfg, imi_entry_t *entry) {
+	if (cfg->fixed && entry->key) __imi_schema_del(cfg, entry);
 
-			continue;
-		}
+	if ((!entry->key && !entry->parent) || !cfg->cap) return;
 
-		if (*l == '[') {
-			if (!__imi_parse_section(l, section)) continue;
+	size_t mask = cfg->cap - 1;
 
-			__imi_create_section(cfg, section, current_comment);
+	for (size_t i = entry->hash & mask; cfg->slots[i].entry; i = (i + 1) & mask) {
+		if (cfg->slots[i].entry != entry) continue;
 
-			current_comment[0] = '\0';
+		cfg->slots[i].entry = __IMI_TOMB;
 
-			continue;
+		for (imi_entry_t *e = entry->next; e; e = e->next) {
+			if (e->hash == entry->hash && __imi_index_match(e, entry->key ? entry->key : entry->parent, !entry->key)) {
+				__imi_index_insert(cfg, e);
+
+				break;
+			}
 		}
 
-		__imi_parse_key_value(cfg, l, section, current_comment, flags);
+		return;
 	}
-
-	return 0;
 }
 
 /* ============================================================================
- * FILE OPERATIONS
+ * SECTION TREE
+ * Kept in step with the list by __imi_list_append / inimini_remove. Nodes live on the heap in
+ * both allocation modes. If a node can't be allocated its entries just stay out of the tree.
  * ========================================================================== */
-static inline FILE *inimini_sysconf(const char *progname, char * restrict mode) {
-	size_t size = 4096;
-	char path[4096] =  {0};
+static inline imi_node_t *__imi_tree_find(const inimini_t *cfg, const char *path, size_t len, uint64_t hash) {
+	if (!cfg->tcap) return NULL;
 
-	#if defined(_WIN32)
-		snprintf(path, size, "C:/ProgramData/%s/%s.%s", progname, progname, IMI_SUFFIXED);
-	#else
-		snprintf(path, size, "/etc/%s/%s.%s", progname, progname, IMI_SUFFIXED);
-	#endif
+	for (imi_node_t *n = cfg->tree[hash & (cfg->tcap - 1)]; n; n = n->chain) {
+		if (n->hash == hash && !strncmp(n->path, path, len) && !n->path[len]) return n;
+	}
 
-	return fopen(path, mode);
+	return NULL;
 }
 
-static inline FILE *inimini_usrconf(const char *progname, char * restrict mode) {
-	size_t size = 4096;
-	char path[4096] = {0};
+static inline int __imi_tree_grow(inimini_t *cfg) {
+	size_t cap = cfg->tcap ? cfg->tcap * 2 : 16;
+	imi_node_t **tree = (imi_node_t **)calloc(cap, sizeof(imi_node_t *));
 
-	#if defined(_WIN32)
-		char *appdata = getenv("APPDATA");
+	if (!tree) return -1;
 
-		if (appdata) snprintf(path, size, "%s\\%s.%s", appdata, progname, IMI_SUFFIXED);
+	for (size_t i = 0; i < cfg->tcap; i++) {
+		imi_node_t *n = cfg->tree[i];
 
-		char *home = access(path, F_OK) ? getenv("USERPROFILE") : NULL;
+		while (n) {
+			imi_node_t *chain = n->chain;
 
-		if (home) snprintf(path, size, "%s\\.config\\%s.%s", home, progname, IMI_SUFFIXED);
-	#elif defined(__ANDROID__)
-		char *home = getenv("HOME");
+			n->chain = tree[n->hash & (cap - 1)];
+			tree[n->hash & (cap - 1)] = n;
+			n = chain;
+		}
+	}
 
-		if (home) snprintf(path, size, "%s/.%s%s", home, progname, IMI_SUFFIXED);
+	free(cfg->tree);
 
-		char *pkgdir = access(path, F_OK) ? getenv("ANDROID_APP_DIR") : NULL;
+	cfg->tree = tree;
+	cfg->tcap = cap;
 
-		if (pkgdir) snprintf(path, size, "%s/config/%s.%s", pkgdir, progname,  IMI_SUFFIXED);
-	#elif defined(__APPLE__)
-		char *home = getenv("HOME");
+	return 0;
+}
 
-		if (home) snprintf(path, size, "%s/.%s%s", home, progname, IMI_SUFFIXED);
-	#else
-		char *xdg = getenv("XDG_CONFIG_HOME");
+/* Find or create the node for path, creating missing prefix nodes on the way. FNV-1a is
+ * incremental, so every prefix hash falls out of a single pass over the path. */
+static inline imi_node_t *__imi_tree_node(inimini_t *cfg, const char *path) {
+	uint64_t h = 0xcbf29ce484222325ULL;
+	imi_node_t *up = NULL;
 
-		if (xdg) snprintf(path, size, "%s/%s/%s.%s", xdg, progname, progname, IMI_SUFFIXED);
+	for (size_t i = 0; ; i++) {
+		if (path[i] && path[i] != '.') {
+			h ^= (unsigned char)path[i];
+			h *= 0x100000001b3ULL;
 
-		char *home = access(path, F_OK) ? getenv("HOME") : NULL;
+			continue;
+		}
 
-		if (home) snprintf(path, size, "%s/.%s%s", home, progname, IMI_SUFFIXED);
-	#endif
+		imi_node_t *n = __imi_tree_find(cfg, path, i, h);
 
-	return fopen(path, mode);
-}
+		if (!n) {
+			if (cfg->nodes >= cfg->tcap && __imi_tree_grow(cfg)) return NULL;
 
-static inline FILE *inimini_dirconf(const char *progname, char * restrict mode) {
-	size_t size = 4096;
-	char path[4096] =  {0};
+			n = (imi_node_t *)calloc(1, sizeof(imi_node_t));
 
-	snprintf(path, size, "./.%s%s", progname, IMI_SUFFIXED);
+			if (!n || !(n->path = (char *)malloc(i + 1))) {
+				free(n);
 
-	return fopen(path, mode);
+				return NULL;
+			}
+
+			memcpy(n->path, path, i);
+
+			n->path[i] = '\0';
+			n->hash = h;
+			n->up = up;
+			n->chain = cfg->tree[h & (cfg->tcap - 1)];
+			cfg->tree[h & (cfg->tcap - 1)] = n;
+			cfg->nodes++;
+
+			if (up) {
+				if (up->ctail) up->ctail->sibling = n;
+				else up->child = n;
+
+				up->ctail = n;
+			}
+		}
+
+		if (!path[i]) return n;
+
+		h ^= '.';
+		h *= 0x100000001b3ULL;
+		up = n;
+	}
+}
+
+/* prev is the entry appended before e - runs of one section reuse its node without hashing */
+static inline void __imi_tree_add(inimini_t *cfg, imi_entry_t *e, const imi_entry_t *prev) {
+	imi_node_t *n = NULL;
+
+	if (prev && prev->sect && e->parent && !strcmp(prev->sect->path, e->parent)) n = prev->sect;
+	else if (e->parent) n = __imi_tree_node(cfg, e->parent);
+
+	if (!n) return;
+
+	if (!n->refs++) {
+		n->lprev = cfg->stail;
+
+		if (cfg->stail) cfg->stail->lnext = n;
+		else cfg->secs = n;
+
+		cfg->stail = n;
+		cfg->nsecs++;
+	}
+
+	e->sect = n;
+
+	size_t plen = strlen(n->path);
+
+	/* Only keys spelled "<parent>.<leaf>" are listed, getsub hands out the leaf in place */
+	if (!e->key || strncmp(e->key, n->path, plen) || e->key[plen] != '.') return;
+
+	e->sprev = n->last;
+
+	if (n->last) n->last->snext = e;
+	else n->first = e;
+
+	n->last = e;
+
+	for (; n; n = n->up) n->keys++;
+}
+
+/* Unhook an entry, pruning nodes that no longer lead anywhere */
+static inline void __imi_tree_del(inimini_t *cfg, imi_entry_t *e) {
+	imi_node_t *n = e->sect;
+
+	if (!n) return;
+
+	if (e->sprev || n->first == e) {
+		if (e->sprev) e->sprev->snext = e->snext;
+		else n->first = e->snext;
+
+		if (e->snext) e->snext->sprev = e->sprev;
+		else n->last = e->sprev;
+
+		for (imi_node_t *u = n; u; u = u->up) u->keys--;
+	}
+
+	e->sect = NULL;
+	e->snext = e->sprev = NULL;
+
+	if (--n->refs) return;
+
+	if (n->lprev) n->lprev->lnext = n->lnext;
+	else cfg->secs = n->lnext;
+
+	if (n->lnext) n->lnext->lprev = n->lprev;
+	else cfg->stail = n->lprev;
+
+	n->lnext = n->lprev = NULL;
+	cfg->nsecs--;
+
+	while (n && !n->refs && !n->child) {
+		imi_node_t *up = n->up;
+		imi_node_t *prev = NULL;
+		imi_node_t **bp = &cfg->tree[n->hash & (cfg->tcap - 1)];
+
+		for (imi_node_t *c = up ? up->child : n; c != n; c = c->sibling) prev = c;
+		while (*bp != n) bp = &(*bp)->chain;
+
+		if (up) {
+			if (prev) prev->sibling = n->sibling;
+			else up->child = n->sibling;
+
+			if (up->ctail == n) up->ctail = prev;
+		}
+
+		*bp = n->chain;
+		cfg->nodes--;
+
+		free(n->path);
+		free(n);
+
+		n = up;
+	}
+}
+
+static inline void __imi_tree_free(inimini_t *cfg) {
+	for (size_t i = 0; i < cfg->tcap; i++) {
+		imi_node_t *n = cfg->tree[i];
+
+		while (n) {
+			imi_node_t *chain = n->chain;
+
+			free(n->path);
+			free(n);
+
+			n = chain;
+		}
+	}
+
+	free(cfg->tree);
+
+	cfg->tree = NULL;
+	cfg->secs = cfg->stail = NULL;
+	cfg->tcap = cfg->nodes = cfg->nsecs = 0;
+}
+
+/* Preorder successor of n within the subtree at root, climbing back through up (no stack) */
+static inline const imi_node_t *__imi_tree_next(const imi_node_t *root, const imi_node_t *n) {
+	if (n->child) return n->child;
+
+	while (n != root && !n->sibling) n = n->up;
+
+	return n == root ? NULL : n->sibling;
+}
+
+static inline imi_node_t *__imi_tree_get(const inimini_t *cfg, const char *path) {
+	return __imi_tree_find(cfg, path, strlen(path), __imi_hash(path));
+}
+
+static inline void __imi_notify(const inimini_t *cfg, const char *key, const char *value);
+
+/* A key appended while nothing indexed it before is a value appearing, so subscribers hear it */
+static inline void __imi_list_append(inimini_t *cfg, imi_entry_t *entry) {
+	if (!entry) return;
+
+	imi_entry_t *prev = cfg->tail;
+
+	entry->next = NULL;
+
+	if (!cfg->head) {
+		cfg->head = cfg->tail = entry;
+	} else {
+		cfg->tail->next = entry;
+		cfg->tail = entry;
+	}
+
+	cfg->count++;
+
+	__imi_index_add(cfg, entry);
+	__imi_tree_add(cfg, entry, prev);
+
+	if (cfg->subs && entry->key && cfg->cap && __imi_index_find(cfg, entry->key, entry->hash, 0) == entry) __imi_notify(cfg, entry->key, entry->value);
+}
+
+/* Append a copy of o owned by cfg */
+static inline int __imi_entry_copy(inimini_t *cfg, const imi_entry_t *o) {
+	imi_entry_t *e = (imi_entry_t *)__imi_alloc(cfg, sizeof(imi_entry_t));
+
+	if (!e) return -1;
+
+	e->key = o->key ? __imi_strdup(cfg, o->key) : NULL;
+	e->value = o->value ? __imi_strdup(cfg, o->value) : NULL;
+	e->parent = __imi_strdup(cfg, o->parent ? o->parent : "");
+	e->comment = o->comment ? __imi_strdup(cfg, o->comment) : NULL;
+
+	__imi_list_append(cfg, e);
+
+	return 0;
+}
+
+static inline imi_entry_t *__imi_find_entry(const inimini_t *cfg, const char *key) {
+	if (!key) return NULL;
+
+	if (cfg->cap) return __imi_index_find(cfg, key, __imi_hash(key), 0);
+
+	for (imi_entry_t *e = cfg->head; e; e = e->next) {
+		if (e->key && !strcmp(e->key, key)) return e;
+	}
+
+	return NULL;
+}
+
+/* Section marker ([name] line) lookup */
+static inline imi_entry_t *__imi_find_section(const inimini_t *cfg, const char *name) {
+	if (!name) return NULL;
+
+	if (cfg->cap) return __imi_index_find(cfg, name, __imi_hash(name) ^ __IMI_SECTION_SEED, 1);
+
+	for (imi_entry_t *e = cfg->head; e; e = e->next) {
+		if (!e->key && e->parent && !strcmp(e->parent, name)) return e;
+	}
+
+	return NULL;
+}
+
+/* ============================================================================
+ * SUBSCRIPTIONS
+ * Shared by cfg (setstr/remove/merge), the file watcher and reload handles. Callbacks run on the
+ * thread making the change and must not subscribe or unsubscribe themselves.
+ * ========================================================================== */
+static inline imi_subnode_t *__imi_subs_step(imi_subnode_t *n, unsigned char c, int create) {
+	imi_subnode_t **pp = &n->child;
+
+	while (*pp && (*pp)->c != c) pp = &(*pp)->sibling;
+
+	if (!*pp && create && (*pp = (imi_subnode_t *)calloc(1, sizeof(imi_subnode_t)))) (*pp)->c = c;
+
+	return *pp;
+}
+
+static inline int __imi_subs_add(imi_subnode_t **root, const char *prefix, imi_sub_fn fn, void *ctx) {
+	if (!fn || !prefix) return -1;
+
+	if (!*root && !(*root = (imi_subnode_t *)calloc(1, sizeof(imi_subnode_t)))) return -1;
+
+	imi_subnode_t *n = *root;
+
+	for (const char *p = prefix; *p && n; p++) n = __imi_subs_step(n, (unsigned char)*p, 1);
+
+	imi_sub_t *sub = n ? (imi_sub_t *)malloc(sizeof(imi_sub_t)) : NULL;
+
+	if (!sub) return -1;
+
+	sub->fn = fn;
+	sub->ctx = ctx;
+	sub->next = n->subs;
+	n->subs = sub;
+
+	return 0;
+}
+
+/* Nodes stay in place once created, they are released with the owner */
+static inline int __imi_subs_del(imi_subnode_t *root, const char *prefix, imi_sub_fn fn, void *ctx) {
+	imi_subnode_t *n = root;
+
+	for (const char *p = prefix; n && *p; p++) n = __imi_subs_step(n, (unsigned char)*p, 0);
+
+	for (imi_sub_t **pp = n ? &n->subs : NULL; pp && *pp; pp = &(*pp)->next) {
+		if ((*pp)->fn != fn || (*pp)->ctx != ctx) continue;
+
+		imi_sub_t *sub = *pp;
+
+		*pp = sub->next;
+
+		free(sub);
+
+		return 0;
+	}
+
+	return -1;
+}
+
+static inline void __imi_subs_fire(const imi_subnode_t *root, const char *key, const char *value) {
+	const imi_subnode_t *n = root;
+
+	for (const char *p = key; n; p++) {
+		for (const imi_sub_t *sub = n->subs; sub; sub = sub->next) sub->fn(key, value, sub->ctx);
+
+		if (!*p) break;
+
+		n = __imi_subs_step((imi_subnode_t *)n, (unsigned char)*p, 0);
+	}
+}
+
+static inline void __imi_subs_free(imi_subnode_t *n) {
+	while (n) {
+		imi_subnode_t *sibling = n->sibling;
+
+		while (n->subs) {
+			imi_sub_t *next = n->subs->next;
+
+			free(n->subs);
+
+			n->subs = next;
+		}
+
+		__imi_subs_free(n->child);
+		free(n);
+
+		n = sibling;
+	}
+}
+
+static inline int __imi_same(const char *a, const char *b) {
+	return a == b || (a && b && !strcmp(a, b));
+}
+
+static inline void __imi_notify(const inimini_t *cfg, const char *key, const char *value) {
+	if (cfg->subs && key) __imi_subs_fire(cfg->subs, key, value);
+}
+
+/* Call fn for every key starting with prefix ("" = all) whenever setstr/set*, remove, merge or a
+ * later read or include change its effective value. value is NULL once the key is gone. */
+static inline int inimini_subscribe(inimini_t *cfg, const char *prefix, imi_sub_fn fn, void *ctx) {
+	return cfg ? __imi_subs_add(&cfg->subs, prefix, fn, ctx) : -1;
+}
+
+static inline int inimini_unsubscribe(inimini_t *cfg, const char *prefix, imi_sub_fn fn, void *ctx) {
+	return cfg && prefix ? __imi_subs_del(cfg->subs, prefix, fn, ctx) : -1;
+}
+
+/* ============================================================================
+ * OBJECT LIFECYCLE
+ * ========================================================================== */
+static inline inimini_t *inimini_new(void) {
+	inimini_t *cfg = (inimini_t *)calloc(1, sizeof(inimini_t));
+
+	return cfg;
+}
+
+/* Arena mode: size_hint pre-sizes the first chunk (0 = IMI_ARENA_CHUNK). Replaced or removed
+ * values stay in the arena until inimini_free() / inimini_clear(), so prefer it for configs that
+ * are loaded and read rather than heavily edited. */
+static inline inimini_t *inimini_new_arena(size_t size_hint) {
+	inimini_t *cfg = (inimini_t *)calloc(1, sizeof(inimini_t));
+
+	if (!cfg) return NULL;
+
+	size_t size = size_hint > IMI_ARENA_CHUNK ? size_hint : IMI_ARENA_CHUNK;
+
+	cfg->arena = (imi_chunk_t *)malloc(sizeof(imi_chunk_t) + size);
+
+	if (!cfg->arena) {
+		free(cfg);
+
+		return NULL;
+	}
+
+	cfg->arena->next = NULL;
+	cfg->arena->size = size;
+	cfg->arena->used = 0;
+	cfg->chunk = IMI_ARENA_CHUNK;
+
+	return cfg;
+}
+
+static inline void inimini_free(inimini_t *cfg) {
+	if (!cfg) return;
+
+	imi_entry_t *e = cfg->head;
+
+	while (e) {
+		imi_entry_t *next = e->next;
+
+		__imi_free_entry(cfg, e);
+
+		e = next;
+	}
+
+	__imi_arena_free(cfg);
+	__imi_blocks_free(cfg);
+	__imi_sources_free(cfg);
+	__imi_tree_free(cfg);
+	__imi_subs_free(cfg->subs);
+
+	free(cfg->fixed);
+	free(cfg->slots);
+	free(cfg);
+}
+
+/* ============================================================================
+ * STRUCTURAL SCANNER
+ * One classification pass per 64-byte block marks every '\n', '=', ']', ';' and '#'. The parser
+ * then hops between marked bytes instead of re-running strchr/isspace over each line, so plain
+ * key=value lines cost a couple of bit operations. SSE2/AVX2 when the compiler targets them,
+ * scalar otherwise (or with IMI_NO_SIMD).
+ * ========================================================================== */
+#if !defined(IMI_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define __IMI_AVX2 1
+#elif !defined(IMI_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#include <emmintrin.h>
+#define __IMI_SSE2 1
+#endif
+
+#define __IMI_BLOCK 64
+
+/* Offsets of one line's structure, relative to the line start (len when absent) */
+typedef struct {
+	size_t len;   /* Line terminator ('\n' or end of buffer) */
+	size_t eq;    /* First '=' */
+	size_t rbr;   /* First ']' */
+	size_t semi;  /* First ';' after eq */
+	size_t hash;  /* First '#' after eq */
+} imi_marks_t;
+
+typedef struct {
+	const char *base;  /* Scanned buffer */
+	size_t     size;   /* Buffer length */
+	size_t     blk;    /* Offset of the current block */
+	size_t     next;   /* Offset of the next block to classify */
+	uint64_t   bits;   /* Unconsumed structural bytes of the current block */
+} imi_scan_t;
+
+static inline int __imi_isspace(char c) {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/* Trim [s, *e) in place, NUL-terminate and report the new end through e */
+static inline char *__imi_trim_span(char *s, char **e) {
+	while (s < *e && __imi_isspace(*s)) s++;
+	while (*e > s && __imi_isspace((*e)[-1])) (*e)--;
+
+	**e = '\0';
+
+	return s;
+}
+
+static inline unsigned __imi_ctz64(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned)__builtin_ctzll(v);
+#else
+	unsigned n = 0;
+
+	while (!(v & 1)) {
+		v >>= 1;
+		n++;
+	}
+
+	return n;
+#endif
+}
+
+static inline uint64_t __imi_classify(const char *p, size_t n) {
+	uint64_t bits = 0;
+	size_t i = 0;
+
+#if defined(__IMI_AVX2)
+	if (n == __IMI_BLOCK) {
+		for (; i < __IMI_BLOCK; i += 32) {
+			__m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+			__m256i m = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('='))),
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(']')),
+					_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(';')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('#')))));
+
+			bits |= (uint64_t)(uint32_t)_mm256_movemask_epi8(m) << i;
+		}
+
+		return bits;
+	}
+#elif defined(__IMI_SSE2)
+	if (n == __IMI_BLOCK) {
+		for (; i < __IMI_BLOCK; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+			__m128i m = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('='))),
+				_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(']')),
+					_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(';')), _mm_cmpeq_epi8(v, _mm_set1_epi8('#')))));
+
+			bits |= (uint64_t)(uint16_t)_mm_movemask_epi8(m) << i;
+		}
+
+		return bits;
+	}
+#endif
+
+	for (; i < n; i++) {
+		char c = p[i];
+
+		if (c == '\n' || c == '=' || c == ']' || c == ';' || c == '#') bits |= (uint64_t)1 << i;
+	}
+
+	return bits;
+}
+
+/* Next structural byte, NULL once the buffer is exhausted */
+static inline const char *__imi_scan_next(imi_scan_t *s) {
+	while (!s->bits) {
+		if (s->next >= s->size) return NULL;
+
+		size_t n = s->size - s->next < __IMI_BLOCK ? s->size - s->next : __IMI_BLOCK;
+
+		s->blk = s->next;
+		s->bits = __imi_classify(s->base + s->blk, n);
+		s->next += n;
+	}
+
+	const char *p = s->base + s->blk + __imi_ctz64(s->bits);
+
+	s->bits &= s->bits - 1;
+
+	return p;
+}
+
+/* Consume the marks of the line starting at line. Blocks are classified ahead of the in-place
+ * writes the parser does on a line, and those writes never reach past its terminator. */
+static inline void __imi_scan_line(imi_scan_t *s, const char *line, imi_marks_t *m) {
+	size_t len = s->base + s->size - line;
+	const char *p;
+
+	m->len = m->eq = m->rbr = m->semi = m->hash = len;
+
+	while ((p = __imi_scan_next(s))) {
+		size_t off = p - line;
+
+		if (*p == '\n') {
+			m->len = off;
+
+			break;
+		}
+
+		if (*p == '=' && m->eq == len) m->eq = off;
+		else if (*p == ']' && m->rbr == len) m->rbr = off;
+		else if (*p == ';' && m->eq < off && m->semi == len) m->semi = off;
+		else if (*p == '#' && m->eq < off && m->hash == len) m->hash = off;
+	}
+
+	if (m->eq > m->len) m->eq = m->len;
+	if (m->rbr > m->len) m->rbr = m->len;
+	if (m->semi > m->len) m->semi = m->len;
+	if (m->hash > m->len) m->hash = m->len;
+}
+
+/* ============================================================================
+ * PARSER OPERATIONS
+ * ========================================================================== */
+/* INCLUDE FRAME: File being parsed, chained through the files that included it */
+typedef struct imi_frame {
+	const struct imi_frame *up; /* Including file, NULL at top level */
+	const char *path;           /* Canonical path, NULL for in-memory buffers */
+	int depth;                  /* Include nesting level */
+} imi_frame_t;
+
+/* Defined with the include cache below, which parses fragments through __imi_parse_mem */
+static inline void __imi_include(inimini_t *cfg, const char *section, const char *raw, uint32_t flags, const imi_frame_t *frame);
+
+static inline int __imi_include_section(const char *section) {
+	#if defined(_WIN32)
+		(void)section;
+
+		return 0;
+	#else
+		return !strcmp(section, "include") || (!strncmp(section, "includeIf", 9) && isspace((unsigned char)section[9]));
+	#endif
+}
+
+/* Upsert: x takes over value (and comment unless empty) from a later definition of its key */
+static inline void __imi_replace(inimini_t *cfg, imi_entry_t *x, char *value, char *comment) {
+	int same = __imi_same(x->value, value);
+
+	__imi_release(cfg, x->value);
+	free(x->parsed);
+
+	x->value = value;
+	x->parsed = NULL;
+	x->typed = 0;
+
+	/* An empty comment keeps the old one, but still replaces an old empty one so the view it
+	 * holds doesn't pin the previous source block */
+	if (comment && (*comment || !x->comment || !*x->comment)) {
+		__imi_release(cfg, x->comment);
+
+		x->comment = comment;
+	} else {
+		__imi_release(cfg, comment);
+	}
+
+	if (!same) __imi_notify(cfg, x->key, x->value);
+}
+
+/* Stack a copy of o onto cfg: appended, or with IMI_UPSERT folded into the entry cfg already has */
+static inline int __imi_entry_stack(inimini_t *cfg, const imi_entry_t *o, uint32_t flags) {
+	imi_entry_t *x = (flags & IMI_UPSERT) ? (o->key ? __imi_find_entry(cfg, o->key) : __imi_find_section(cfg, o->parent)) : NULL;
+
+	if (!x) return __imi_entry_copy(cfg, o);
+
+	if (o->key) __imi_replace(cfg, x, o->value ? __imi_strdup(cfg, o->value) : NULL, o->comment && *o->comment ? __imi_strdup(cfg, o->comment) : NULL);
+
+	return 0;
+}
+
+static inline void __imi_create_section(inimini_t *cfg, const char *name, const char *comment, uint32_t flags) {
+	imi_entry_t *e = (flags & IMI_UPSERT) ? __imi_find_section(cfg, name) : NULL;
+
+	if (e) {
+		if (*comment) {
+			__imi_release(cfg, e->comment);
+
+			e->comment = __imi_strdup(cfg, comment);
+		}
+
+		return;
+	}
+
+	e = (imi_entry_t *)__imi_alloc(cfg, sizeof(imi_entry_t));
+
+	if (!e) return;
+
+	e->key = NULL;
+	e->parent = __imi_strdup(cfg, name);
+	e->comment = *comment ? __imi_strdup(cfg, comment) : NULL;
+
+	__imi_list_append(cfg, e);
+}
+
+/* Append to the pending comment buffer (IMI_COMMENT_LEN bytes), truncating when full */
+static inline void __imi_append_comment(char *buf, const char *text) {
+	size_t len = strlen(buf);
+
+	if (len && len < IMI_COMMENT_LEN - 1) buf[len++] = '\n';
+
+	snprintf(buf + len, IMI_COMMENT_LEN - len, "%s", text);
+}
+
+static inline void __imi_parse_comment(char *line, char *buf) {
+	__imi_append_comment(buf, __imi_trim(line + 1));
+}
+
+static inline int __imi_parse_section(const char *start, const char *end, char *section) {
+	char name[IMI_SECTION_LEN] = {0};
+
+	if (!end) return 0;
+
+	size_t slen = end - ++start;
+
+	if (slen >= IMI_SECTION_LEN) slen = IMI_SECTION_LEN - 1;
+
+	memcpy(name, start, slen);
+
+	strcpy(section, __imi_trim(name));
+
+	return 1;
+}
+
+static inline void __imi_parse_key_value(inimini_t *cfg, char *line, const imi_marks_t *m, const char *section, char *comment, uint32_t flags, const imi_frame_t *frame) {
+	if (m->eq == m->len) return;
+
+	/* line is the parser's scratch buffer, so trim in place rather than copying */
+	char *kend = line + m->eq;
+	char *key = __imi_trim_span(line, &kend);
+	char *vend = line + m->len;
+	char *val = __imi_trim_span(line + m->eq + 1, &vend);
+
+	if (vend - val >= 2 && val[0] == '"' && vend[-1] == '"') {
+		*--vend = '\0';
+		val++;
+	}
+
+	if (flags & IMI_COMMENTS) {
+		char *trailing_com = line + m->semi < vend ? line + m->semi : line + m->hash < vend ? line + m->hash : NULL;
+
+		if (trailing_com) {
+			char *cend = vend;
+
+			__imi_append_comment(comment, __imi_trim_span(trailing_com + 1, &cend));
+
+			vend = trailing_com;
+			val = __imi_trim_span(val, &vend);
+		}
+	}
+
+	if ((flags & IMI_INCLUDES) && !strcmp(key, "path") && __imi_include_section(section)) {
+		__imi_include(cfg, section, val, flags, frame);
+
+		return;
+	}
+
+	char tmpkey[IMI_KEY_LEN];
+
+	if (section[0]) snprintf(tmpkey, IMI_KEY_LEN, "%s.%s", section, key);
+	else if (!strchr(key, '.')) snprintf(tmpkey, IMI_KEY_LEN, "%s.%s", IMI_DEFAULT, key);
+	else snprintf(tmpkey, IMI_KEY_LEN, "%s", key);
+
+	char *value = strstr(val, "${") ? __imi_expand_env(cfg, val) : val;
+	char *note = *comment ? __imi_strdup(cfg, comment) : line + m->len; /* empty view, no alloc */
+
+	__imi_view(cfg, value);
+	__imi_view(cfg, note);
+	imi_entry_t *e = (flags & IMI_UPSERT) ? __imi_find_entry(cfg, tmpkey) : NULL;
+
+	if (e) {
+		__imi_replace(cfg, e, value, note);
+
+		return;
+	}
+
+	if (!(e = (imi_entry_t *)__imi_alloc(cfg, sizeof(imi_entry_t)))) {
+		__imi_release(cfg, value);
+		__imi_release(cfg, note);
+
+		return;
+	}
+
+	e->key = __imi_strdup(cfg, tmpkey);
+	e->value = value;
+	e->parent = __imi_extract_parent(cfg, e->key);
+	e->comment = note;
+
+	__imi_list_append(cfg, e);
+}
+
+/* In-place scanner over a block: buf[len] must be writable, values end up as views into buf */
+static inline int __imi_parse_mem(inimini_t *cfg, char *buf, size_t len, uint32_t flags, const imi_frame_t *frame) {
+	char section[IMI_SECTION_LEN] = {0}, current_comment[IMI_COMMENT_LEN] = {0};
+	imi_scan_t scan = { buf, len, 0, 0, 0 };
+	char *end = buf + len;
+	char *line = buf;
+
+	while (line < end) {
+		imi_marks_t m;
+
+		__imi_scan_line(&scan, line, &m);
+
+		char *cur = line;
+		char *l = line;
+
+		line[m.len] = '\0';
+		line += m.len + 1;
+
+		while (__imi_isspace(*l)) l++;
+
+		if (!*l) {
+			current_comment[0] = '\0';
+
+			continue;
+		}
+
+		if (*l == ';' || *l == '#') {
+			__imi_parse_comment(l, current_comment);
+
+			continue;
+		}
+
+		if (*l == '[') {
+			if (!__imi_parse_section(l, m.rbr < m.len ? cur + m.rbr : NULL, section)) continue;
+
+			if (!(flags & IMI_INCLUDES) || !__imi_include_section(section)) __imi_create_section(cfg, section, current_comment, flags);
+
+			current_comment[0] = '\0';
+
+			continue;
+		}
+
+		__imi_parse_key_value(cfg, cur, &m, section, current_comment, flags, frame);
+	}
+
+	return 0;
+}
+
+/* Parse a freshly pushed block, dropping it again if no entry kept a view into it */
+static inline int __imi_parse_block(inimini_t *cfg, imi_block_t *b, uint32_t flags, const imi_frame_t *frame) {
+	b->busy = 1;
+
+	int ret = __imi_parse_mem(cfg, b->data, b->size, flags, frame);
+
+	b->busy = 0;
+
+	if (!b->views) __imi_block_drop(cfg, b);
+
+	return ret;
+}
+
+/* path (if known) anchors relative includes and seeds cycle detection */
+static inline int __imi_parse(inimini_t *cfg, FILE *f, uint32_t flags, const char *path) {
+	imi_block_t *b = __imi_block_file(cfg, f, flags);
+	imi_frame_t top = { NULL, path, 0 };
+
+	if (!b) return -1;
+
+	#if !defined(_WIN32)
+		char real[4096];
+
+		if (path && (flags & IMI_INCLUDES) && realpath(path, real)) top.path = real;
+	#endif
+
+	return __imi_parse_block(cfg, b, flags, &top);
+}
+
+/* ============================================================================
+ * INCLUDES
+ * Fragments named by include directives are parsed once per process into a cache keyed on
+ * (canonical path, size, mtime, inode, flags) and their entries copied in at the directive,
+ * so a file shared by several configs is read from disk only while it keeps changing.
+ * Cached fragments keep their own directives as plain keys, resolved on every splice, so
+ * nested files are checked too and cycles are caught against the live include chain.
+ * ========================================================================== */
+static inline void __imi_stamp(const char *path, imi_stamp_t *s) {
+	struct stat st;
+
+	memset(s, 0, sizeof(*s));
+
+	if (!path[0] || stat(path, &st)) return;
+
+	s->path = __imi_hash(path) | 1;
+	s->size = (uint64_t)st.st_size;
+	s->ino = (uint64_t)st.st_ino;
+
+#if defined(__APPLE__)
+	s->mtime = (uint64_t)st.st_mtimespec.tv_sec * 1000000000ULL + st.st_mtimespec.tv_nsec;
+#elif !defined(_WIN32) && (defined(__USE_XOPEN2K8) || (defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L) || (defined(_XOPEN_SOURCE) && _XOPEN_SOURCE >= 700))
+	s->mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + st.st_mtim.tv_nsec;
+#else
+	/* Strict ISO modes hide st_mtim: whole seconds, size and inode still catch most edits */
+	s->mtime = (uint64_t)st.st_mtime * 1000000000ULL;
+#endif
+}
+
+/* The .git directory enclosing the working directory, -1 outside any repository */
+static inline int __imi_gitdir(char *dir, size_t size) {
+	#if defined(_WIN32)
+		(void)dir; (void)size;
+
+		return -1;
+	#else
+		if (size < 8 || !getcwd(dir, size - 6)) return -1;
+
+		for (;;) {
+			size_t n = strlen(dir);
+			struct stat st;
+
+			snprintf(dir + n, size - n, "%s.git", n > 1 ? "/" : "");
+
+			if (!stat(dir, &st)) return 0;
+
+			dir[n] = '\0';
+
+			char *slash = strrchr(dir, '/');
+
+			if (!slash || n <= 1) return -1;
+
+			slash[slash == dir] = '\0';
+		}
+	#endif
+}
+
+/* State of a source right now, to compare with the one recorded at parse time */
+static inline void __imi_source_stamp(int kind, const char *path, imi_stamp_t *s) {
+	char dir[4096];
+
+	if (kind == __IMI_SRC_FILE) __imi_stamp(path, s);
+	else if (kind == __IMI_SRC_ENV) __imi_env_stamp(getenv(path), s);
+	else if (kind == __IMI_SRC_GIT) __imi_env_stamp(__imi_gitdir(dir, sizeof(dir)) ? NULL : dir, s);
+	else memset(s, 0xff, sizeof(*s));  /* Unknown kind never matches */
+}
+
+static inline int __imi_sources_fresh(const imi_source_t *src) {
+	for (; src; src = src->next) {
+		imi_stamp_t now;
+
+		__imi_source_stamp(src->kind, src->path, &now);
+
+		if (memcmp(&now, &src->stamp, sizeof(now))) return 0;
+	}
+
+	return 1;
+}
+
+typedef struct imi_include {
+	struct imi_include *next;  /* Next cached fragment */
+	char        *path;         /* Canonical path */
+	imi_stamp_t stamp;         /* File state the fragment was parsed from */
+	uint32_t    flags;         /* Parse flags the fragment was parsed with */
+	inimini_t   *cfg;          /* Parsed fragment (arena) */
+	size_t      refs;          /* Splices in progress */
+	int         stale;         /* Replaced by a newer parse, freed at refs == 0 */
+} imi_include_t;
+
+static imi_include_t *__imi_includes;
+
+#if !defined(_WIN32)
+static pthread_mutex_t __imi_include_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static inline void __imi_include_drop(imi_include_t *inc) {
+	inimini_free(inc->cfg);
+	free(inc->path);
+	free(inc);
+}
+
+/* Cached fragment for path with a reference held, parsing it if missing or out of date */
+static inline imi_include_t *__imi_include_get(const char *path, uint32_t flags) {
+	#if defined(_WIN32)
+		(void)path; (void)flags;
+
+		return NULL;
+	#else
+		imi_include_t *inc = NULL, **pp;
+		imi_stamp_t st;
+
+		__imi_stamp(path, &st);
+
+		if (!st.path) return NULL;
+
+		pthread_mutex_lock(&__imi_include_lock);
+
+		for (pp = &__imi_includes; *pp; pp = &(*pp)->next) {
+			if (strcmp((*pp)->path, path) || (*pp)->flags != flags) continue;
+
+			if (!memcmp(&(*pp)->stamp, &st, sizeof(st)) && __imi_sources_fresh((*pp)->cfg->sources)) {
+				inc = *pp;
+				inc->refs++;
+			} else {
+				imi_include_t *old = *pp;
+
+				*pp = old->next;
+
+				if (old->refs) old->stale = 1;
+				else __imi_include_drop(old);
+			}
+
+			break;
+		}
+
+		pthread_mutex_unlock(&__imi_include_lock);
+
+		if (inc) return inc;
+
+		FILE *f = fopen(path, "r");
+
+		if (!f) return NULL;
+
+		inc = (imi_include_t *)calloc(1, sizeof(imi_include_t));
+
+		if (inc) {
+			inc->path = strdup(path);
+			inc->stamp = st;
+			inc->flags = flags;
+			inc->cfg = inimini_new_arena((size_t)st.size * 2);
+			inc->refs = 1;
+		}
+
+		if (!inc || !inc->path || !inc->cfg || __imi_parse(inc->cfg, f, flags, NULL) < 0) {
+			if (inc) __imi_include_drop(inc);
+
+			fclose(f);
+
+			return NULL;
+		}
+
+		fclose(f);
+
+		pthread_mutex_lock(&__imi_include_lock);
+
+		inc->next = __imi_includes;
+		__imi_includes = inc;
+
+		pthread_mutex_unlock(&__imi_include_lock);
+
+		return inc;
+	#endif
+}
+
+static inline void __imi_include_put(imi_include_t *inc) {
+	#if !defined(_WIN32)
+		pthread_mutex_lock(&__imi_include_lock);
+
+		int drop = !--inc->refs && inc->stale;
+
+		pthread_mutex_unlock(&__imi_include_lock);
+
+		if (drop) __imi_include_drop(inc);
+	#endif
+}
+
+/* Release every cached fragment not currently being spliced */
+static inline void inimini_include_flush(void) {
+	#if !defined(_WIN32)
+		pthread_mutex_lock(&__imi_include_lock);
+
+		imi_include_t **pp = &__imi_includes;
+
+		while (*pp) {
+			imi_include_t *inc = *pp;
+
+			*pp = inc->next;
+
+			if (inc->refs) inc->stale = 1;
+			else __imi_include_drop(inc);
+		}
+
+		pthread_mutex_unlock(&__imi_include_lock);
+	#endif
+}
+
+/* includeIf "gitdir:PATTERN" (or gitdir/i:) - git's matching rules against the .git directory
+ * enclosing the working directory. Other conditions are never true, as in git. */
+static inline int __imi_include_cond(inimini_t *cfg, const char *section, const imi_frame_t *frame) {
+	#if defined(_WIN32)
+		(void)cfg; (void)section; (void)frame;
+
+		return 0;
+	#else
+		const char *q = strchr(section, '"');
+		char cond[IMI_SECTION_LEN], pat[4096], dir[4096];
+		int fold = 0;
+
+		if (!q) return 0;
+
+		snprintf(cond, sizeof(cond), "%s", q + 1);
+
+		char *e = strrchr(cond, '"');
+
+		if (e) *e = '\0';
+
+		const char *p = cond;
+
+		if (!strncmp(p, "gitdir:", 7)) p += 7;
+		else if (!strncmp(p, "gitdir/i:", 9)) p += 9, fold = 1;
+		else return 0;
+
+		/* Locate the enclosing repository - the answer depends on cwd, so it is a source */
+		imi_stamp_t st;
+		int found = !__imi_gitdir(dir, sizeof(dir));
+
+		__imi_env_stamp(found ? dir : NULL, &st);
+		__imi_source_add(cfg, __IMI_SRC_GIT, ".git", &st);
+
+		if (!found) return 0;
+
+		/* ~/ is $HOME, ./ the including file's directory, bare patterns match at any depth */
+		const char *home = NULL;
+		const char *from = frame && frame->path ? frame->path : NULL;
+		const char *slash = from ? strrchr(from, '/') : NULL;
+
+		if (!strncmp(p, "~/", 2) && (home = __imi_getenv(cfg, "HOME"))) snprintf(pat, sizeof(pat), "%s/%s", home, p + 2);
+		else if (!strncmp(p, "./", 2) && slash) snprintf(pat, sizeof(pat), "%.*s/%s", (int)(slash - from), from, p + 2);
+		else if (*p != '/') snprintf(pat, sizeof(pat), "**/%s", p);
+		else snprintf(pat, sizeof(pat), "%s", p);
+
+		size_t plen = strlen(pat);
+
+		if (plen && pat[plen - 1] == '/' && plen + 2 < sizeof(pat)) memcpy(pat + plen, "**", 3);
+
+		if (fold) {
+			for (char *c = pat; *c; c++) *c = tolower((unsigned char)*c);
+			for (char *c = dir; *c; c++) *c = tolower((unsigned char)*c);
+		}
+
+		return !fnmatch(pat, dir, 0);
+	#endif
+}
+
+/* Resolve one directive and copy the fragment in at the current position */
+static inline void __imi_include(inimini_t *cfg, const char *section, const char *raw, uint32_t flags, const imi_frame_t *frame) {
+	#if defined(_WIN32)
+		(void)cfg; (void)section; (void)raw; (void)flags; (void)frame;
+	#else
+		char want[4096], path[4096];
+		const char *home = NULL;
+
+		if (!raw || !*raw || (frame && frame->depth >= IMI_INCLUDE_DEPTH)) return;
+
+		if (strcmp(section, "include") && !__imi_include_cond(cfg, section, frame)) return;
+
+		char *exp = __imi_expand_env(cfg, raw);
+
+		if (!exp) return;
+
+		/* Relative paths are taken from the including file's directory, as in git */
+		const char *from = frame && frame->path ? frame->path : NULL;
+		const char *slash = from ? strrchr(from, '/') : NULL;
+
+		if (!strncmp(exp, "~/", 2) && (home = __imi_getenv(cfg, "HOME"))) snprintf(want, sizeof(want), "%s/%s", home, exp + 2);
+		else if (*exp != '/' && slash) snprintf(want, sizeof(want), "%.*s/%s", (int)(slash - from), from, exp);
+		else snprintf(want, sizeof(want), "%s", exp);
+
+		__imi_release(cfg, exp);
+
+		/* A missing target is a source too: creating it later changes the result */
+		if (!realpath(want, path)) {
+			__imi_source_add(cfg, __IMI_SRC_FILE, want, NULL);
+
+			return;
+		}
+
+		for (const imi_frame_t *fr = frame; fr; fr = fr->up) {
+			if (fr->path && !strcmp(fr->path, path)) return;  /* Cycle */
+		}
+
+		/* Fragments outlive this cfg in the include cache, so they are never mapped */
+		imi_include_t *inc = __imi_include_get(path, flags & ~(uint32_t)(IMI_INCLUDES | IMI_UPSERT | IMI_MMAP));
+
+		if (!inc) {
+			imi_stamp_t st;
+
+			__imi_stamp(path, &st);
+			__imi_source_add(cfg, __IMI_SRC_FILE, path, &st);
+
+			return;
+		}
+
+		__imi_source_add(cfg, __IMI_SRC_FILE, path, &inc->stamp);
+
+		/* Variables the fragment expanded are sources of cfg too */
+		for (const imi_source_t *src = inc->cfg->sources; src; src = src->next) __imi_source_add(cfg, src->kind, src->path, &src->stamp);
+
+		imi_frame_t here = { frame, path, frame ? frame->depth + 1 : 1 };
+
+		for (const imi_entry_t *o = inc->cfg->head; o; o = o->next) {
+			if (__imi_include_section(o->parent)) {
+				const char *leaf = o->key ? o->key + strlen(o->parent) + 1 : NULL;
+
+				if (leaf && !strcmp(leaf, "path")) __imi_include(cfg, o->parent, o->value, flags, &here);
+
+				continue;
+			}
+
+			if (__imi_entry_stack(cfg, o, flags)) break;
+		}
+
+		__imi_include_put(inc);
+	#endif
+}
+
+/* ============================================================================
+ * FILE OPERATIONS
+ * ========================================================================== */
+/* Layer path resolution, shared by the FILE openers below, the compiled cache and watchers */
+static inline void __imi_syspath(const char *progname, char *path, size_t size) {
+	path[0] = '\0';
+
+	#if defined(_WIN32)
+		snprintf(path, size, "C:/ProgramData/%s/%s.%s", progname, progname, IMI_SUFFIXED);
+	#else
+		snprintf(path, size, "/etc/%s/%s.%s", progname, progname, IMI_SUFFIXED);
+	#endif
+}
+
+static inline void __imi_usrpath(const char *progname, char *path, size_t size) {
+	path[0] = '\0';
+
+	#if defined(_WIN32)
+		char *appdata = getenv("APPDATA");
+
+		if (appdata) snprintf(path, size, "%s\\%s.%s", appdata, progname, IMI_SUFFIXED);
+
+		char *home = access(path, F_OK) ? getenv("USERPROFILE") : NULL;
+
+		if (home) snprintf(path, size, "%s\\.config\\%s.%s", home, progname, IMI_SUFFIXED);
+	#elif defined(__ANDROID__)
+		char *home = getenv("HOME");
+
+		if (home) snprintf(path, size, "%s/.%s%s", home, progname, IMI_SUFFIXED);
+
+		char *pkgdir = access(path, F_OK) ? getenv("ANDROID_APP_DIR") : NULL;
+
+		if (pkgdir) snprintf(path, size, "%s/config/%s.%s", pkgdir, progname,  IMI_SUFFIXED);
+	#elif defined(__APPLE__)
+		char *home = getenv("HOME");
+
+		if (home) snprintf(path, size, "%s/.%s%s", home, progname, IMI_SUFFIXED);
+	#else
+		char *xdg = getenv("XDG_CONFIG_HOME");
+
+		if (xdg) snprintf(path, size, "%s/%s/%s.%s", xdg, progname, progname, IMI_SUFFIXED);
+
+		char *home = access(path, F_OK) ? getenv("HOME") : NULL;
+
+		if (home) snprintf(path, size, "%s/.%s%s", home, progname, IMI_SUFFIXED);
+	#endif
+}
+
+static inline void __imi_dirpath(const char *progname, char *path, size_t size) {
+	snprintf(path, size, "./.%s%s", progname, IMI_SUFFIXED);
+}
+
+static inline FILE *inimini_sysconf(const char *progname, const char *mode) {
+	char path[4096];
+
+	__imi_syspath(progname, path, sizeof(path));
+
+	return fopen(path, mode);
+}
+
+static inline FILE *inimini_usrconf(const char *progname, const char *mode) {
+	char path[4096];
+
+	__imi_usrpath(progname, path, sizeof(path));
+
+	return fopen(path, mode);
+}
+
+static inline FILE *inimini_dirconf(const char *progname, const char *mode) {
+	char path[4096];
+
+	__imi_dirpath(progname, path, sizeof(path));
+
+	return fopen(path, mode);
+}
+
+/* Parse an in-memory config. buf needs no NUL terminator and is copied once into a block owned
+ * by cfg, so it may be released right after the call. Files go through the same scanner. */
+static inline int inimini_parse_buf(inimini_t *cfg, const char *buf, size_t len, uint32_t flags) {
+	if (!cfg || (!buf && len)) return -1;
+
+	char *data = (char *)malloc(len + 1);
+
+	if (!data) return -1;
+
+	if (len) memcpy(data, buf, len);
+
+	imi_block_t *b = __imi_block_push(cfg, data, len, 0);
+
+	if (!b) {
+		free(data);
+
+		return -1;
+	}
+
+	return __imi_parse_block(cfg, b, flags, NULL);
+}
+
+static inline int inimini_read(inimini_t *cfg, const char *filepath, uint32_t flags) {
+	FILE *f = fopen(filepath, "r");
+
+	if (!f) return -1;
+
+	int ret = __imi_parse(cfg, f, flags, filepath);
+
+	fclose(f);
+
+	return ret;
+}
+
+/* PARALLEL LOAD: Each layer resolves, reads and parses into a private cfg on its own thread,
+ * then the layers are spliced into cfg in stack order. Entries, blocks and arena chunks are moved
+ * rather than copied, so the result is the same list the serial path builds. */
+typedef struct {
+	inimini_t *cfg;                                 /* Private cfg for this layer */
+	const char *progname;                           /* Program name for path resolution */
+	void (*resolve)(const char *, char *, size_t);  /* __imi_syspath / __imi_usrpath / __imi_dirpath */
+	uint32_t flags;                                 /* Parse flags */
+	int opened;                                     /* 1 = file existed and was parsed */
+} imi_layer_t;
+
+static inline void *__imi_layer_read(void *arg) {
+	imi_layer_t *l = (imi_layer_t *)arg;
+	char path[4096];
+
+	l->resolve(l->progname, path, sizeof(path));
+
+	FILE *f = l->cfg && *path ? fopen(path, "r") : NULL;
+
+	if (f) {
+		__imi_parse(l->cfg, f, l->flags, path);
+		fclose(f);
+
+		l->opened = 1;
+	}
+
+	return NULL;
+}
+
+/* Move every entry, block and arena chunk of layer to the end of cfg, then drop layer. With
+ * IMI_UPSERT an entry whose key cfg already has hands its value over instead. */
+static inline void __imi_splice(inimini_t *cfg, inimini_t *layer, uint32_t flags) {
+	imi_entry_t *e = layer->head;
+
+	/* Storage first, so views and releases below resolve against cfg */
+	if (layer->blocks) {
+		imi_block_t *b = layer->blocks;
+
+		while (b->next) b = b->next;
+
+		b->next = cfg->blocks;
+		cfg->blocks = layer->blocks;
+	}
+
+	/* Moved chunks go behind the current one so cfg keeps bumping where it was */
+	if (layer->arena) {
+		imi_chunk_t *c = layer->arena;
+
+		while (c->next) c = c->next;
+
+		if (cfg->arena) {
+			c->next = cfg->arena->next;
+			cfg->arena->next = layer->arena;
+		} else {
+			cfg->arena = layer->arena;
+		}
+	}
+
+	if (layer->sources) {
+		imi_source_t *src = layer->sources;
+
+		while (src->next) src = src->next;
+
+		src->next = cfg->sources;
+		cfg->sources = layer->sources;
+	}
+
+	while (e) {
+		imi_entry_t *next = e->next;
+		imi_entry_t *x = (flags & IMI_UPSERT) ? (e->key ? __imi_find_entry(cfg, e->key) : __imi_find_section(cfg, e->parent)) : NULL;
+
+		if (x) {
+			if (e->key) {
+				__imi_replace(cfg, x, e->value, e->comment);
+			} else {
+				__imi_release(cfg, e->comment);
+			}
+
+			e->value = e->comment = NULL;
+
+			__imi_free_entry(cfg, e);
+		} else {
+			e->sect = NULL;
+			e->snext = e->sprev = NULL;
+
+			__imi_list_append(cfg, e);
+		}
+
+		e = next;
+	}
+
+	layer->head = layer->tail = NULL;
+	layer->blocks = NULL;
+	layer->sources = NULL;
+	layer->arena = NULL;
+
+	inimini_free(layer);
+}
+
+static inline int __imi_load_parallel(inimini_t *cfg, const char *progname, uint32_t flags) {
+	#if defined(_WIN32)
+		(void)cfg; (void)progname; (void)flags;
+
+		return -1;
+	#else
+		imi_layer_t layers[3] = {
+			{ NULL, progname, __imi_syspath, flags, 0 },
+			{ NULL, progname, __imi_usrpath, flags, 0 },
+			{ NULL, progname, __imi_dirpath, flags, 0 },
+		};
+		pthread_t tid[3];
+		int started[3] = {0};
+		int loaded = 0;
+
+		for (int i = 0; i < 3; i++) {
+			layers[i].cfg = cfg->chunk ? inimini_new_arena(0) : inimini_new();
+
+			if (!layers[i].cfg) {
+				while (i--) {
+					if (started[i]) pthread_join(tid[i], NULL);
+
+					inimini_free(layers[i].cfg);
+				}
+
+				return -1;
+			}
+
+			started[i] = !pthread_create(&tid[i], NULL, __imi_layer_read, &layers[i]);
+		}
+
+		for (int i = 0; i < 3; i++) {
+			if (started[i]) pthread_join(tid[i], NULL);
+			else __imi_layer_read(&layers[i]);
+
+			loaded += layers[i].opened;
+
+			__imi_splice(cfg, layers[i].cfg, flags);
+		}
+
+		return loaded;
+	#endif
+}
+
+static inline int inimini_load(inimini_t *cfg, const char *progname, uint32_t flags) {
+	void (*const resolve[3])(const char *, char *, size_t) = { __imi_syspath, __imi_usrpath, __imi_dirpath };
+	int loaded = 0;
+
+	/* Falls back to the serial path when threads aren't available */
+	if (flags & IMI_PARALLEL) {
+		int ret = __imi_load_parallel(cfg, progname, flags);
+
+		if (ret >= 0) return ret;
+	}
+
+	/* Same paths as inimini_sysconf/usrconf/dirconf, kept so includes resolve next to each layer */
+	for (int i = 0; i < 3; i++) {
+		char path[4096];
+
+		resolve[i](progname, path, sizeof(path));
+
+		FILE *f = fopen(path, "r");
+
+		if (f) {
+			__imi_parse(cfg, f, flags, path);
+			fclose(f);
+
+			loaded++;
+		}
+	}
+
+	return loaded;
+}
+
+/* ============================================================================
+ * WRITE LOGIC (FLAG-BASED FORMATTING)
+ * ========================================================================== */
+static inline void __imi_write_header(FILE *f, const char *parent, uint32_t flags) {
+	if (!parent || !*parent) return;
+
+	if (flags & IMI_GITSTYLE) {
+		if (strchr(parent, ' ')) fprintf(f, "[%s \"%s\"]\n", parent, parent);
+		else fprintf(f, "[%s]\n", parent);
+	} else {
+		fprintf(f, "[%s]\n", parent);
+	}
+}
+
+static inline int __imi_write(const inimini_t *cfg, FILE *f, uint32_t flags) {
+	if (!f) return -1;
+
+	const imi_entry_t *prev = NULL;
+	const char *prev_parent = "";
+	int printed_sections = 0;
+	int write_indent = (flags & IMI_GITSTYLE) ? 1 : 0;
+
+	for (const imi_entry_t *e = cfg->head; e; e = e->next) {
+		const char *current_parent = e->parent ? e->parent : "";
+
+		/* Blank line before new section group */
+		if (prev_parent && strcmp(current_parent, prev_parent) && printed_sections) fprintf(f, "\n");
+
+		/* Print section header on change */
+		if (!prev || (prev_parent && strcmp(current_parent, prev_parent))) {
+			__imi_write_header(f, current_parent, flags);
+
+			printed_sections++;
+		}
+
+		/* Section marker (key == NULL) */
+		if (e->key == NULL) {
+			if (e->comment && (flags & IMI_COMMENTS)) fprintf(f, "; %s\n", e->comment);
+		} else {
+			const char *child = e->key;
+			const char *dot = e->key;
+			int dot_count = 0;
+
+			while (dot_count < IMI_DOTDEPTH - 1) {
+				dot = strchr(dot + 1, '.');
+
+				if (!dot) break;
+
+				dot_count++;
+			}
+
+			if (dot) child = dot + 1;
+
+			/* Apply indent for GITSTYLE */
+			if (write_indent) fprintf(f, "\t%s = %s", child, e->value);
+			else fprintf(f, "%s = %s", child, e->value);
+
+			/* Handle comments */
+			if (e->comment && (flags & IMI_COMMENTS)) fprintf(f, "\n; %s", e->comment);
+
+			fprintf(f, "\n");
+		}
+
+		prev_parent = current_parent;
+		prev = e;
+	}
+
+
+	return 0;
+}
+
+static inline int inimini_write(const inimini_t *cfg, const char *path, uint32_t flags) {
+	FILE *f = fopen(path, "w");
+	int r = __imi_write(cfg, f, flags);
+
+	fclose(f);
+
+	return r;
+}
+
+/* ============================================================================
+ * MERGE LOGIC
+ * ========================================================================== */
+/* Hash join: one pass over overlay, each entry probed in the base index (keys by name, section
+ * markers by parent), so stacking layers is O(n + m). */
+static inline int inimini_merge(inimini_t *base, const inimini_t *overlay, uint32_t flags) {
+	for (const imi_entry_t *o = overlay->head; o; o = o->next) {
+		imi_entry_t *b = o->key ? __imi_find_entry(base, o->key) : __imi_find_section(base, o->parent);
+
+		if (b) {
+			if (o->key) {
+				int same = __imi_same(b->value, o->value);
+
+				__imi_set_value(base, b, o->value);
+
+				if (!same) __imi_notify(base, b->key, b->value);
+			}
+
+			if ((flags & IMI_COMMENTS) && o->comment) {
+				if (o->key == NULL && b->comment) {
+					size_t blen = strlen(b->comment);
+					size_t olen = strlen(o->comment);
+					char *combined = (char *)__imi_alloc(base, blen + olen + 4);
+
+					if (combined) {
+					    memcpy(combined, b->comment, blen);
+					    memcpy(combined + blen, " | ", 3);
+					    memcpy(combined + blen + 3, o->comment, olen + 1);
+
+					    __imi_release(base, b->comment);
+
+					    b->comment = combined;
+					}
+				} else {
+					__imi_release(base, b->comment);
+
+					b->comment = __imi_strdup(base, o->comment);
+				}
+			}
+		} else if (__imi_entry_copy(base, o)) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* ============================================================================
+ * CONFIG DIFF
+ * Two linear passes: b's effective entries are probed in a's index (added / changed), then a's
+ * in b's (removed). Only the first entry of a duplicated key counts, as for lookups. Section
+ * markers take part only for comment changes, with key NULL and section set.
+ * ========================================================================== */
+typedef struct {
+	uint32_t   what;         /* IMI_DIFF_* bits */
+	const char *key;         /* Key (NULL for a section comment change) */
+	const char *section;     /* Parent section */
+	const char *old;         /* Value in a (NULL when added) */
+	const char *value;       /* Value in b (NULL when removed) */
+} imi_change_t;
+
+/* Strings are borrowed from a and b and stay valid while both configs are unchanged */
+typedef struct {
+	imi_change_t *items;     /* Changes, b's list order then removals in a's order */
+	size_t count;            /* Number of changes */
+	size_t cap;              /* Allocated items */
+} inimini_diff_t;
+
+static inline int __imi_diff_push(inimini_diff_t *d, uint32_t what, const imi_entry_t *from, const imi_entry_t *to) {
+	if (d->count == d->cap) {
+		imi_change_t *tmp = (imi_change_t *)realloc(d->items, (d->cap = d->cap ? d->cap * 2 : 32) * sizeof(imi_change_t));
+
+		if (!tmp) return -1;
+
+		d->items = tmp;
+	}
+
+	const imi_entry_t *any = to ? to : from;
+	imi_change_t *c = &d->items[d->count++];
+
+	c->what = what;
+	c->key = any->key;
+	c->section = any->parent;
+	c->old = from ? from->value : NULL;
+	c->value = to ? to->value : NULL;
+
+	return 0;
+}
+
+static inline const char *__imi_diff_comment(const imi_entry_t *e) {
+	return e->comment && *e->comment ? e->comment : NULL;
+}
+
+static inline void inimini_diff_free(inimini_diff_t *d) {
+	if (!d) return;
+
+	free(d->items);
+	free(d);
+}
+
+/* NULL only when memory runs out, an empty diff has count 0 */
+static inline inimini_diff_t *inimini_diff(const inimini_t *a, const inimini_t *b, uint32_t flags) {
+	inimini_diff_t *d = (inimini_diff_t *)calloc(1, sizeof(inimini_diff_t));
+	int comments = flags & IMI_COMMENTS;
+
+	if (!d) return NULL;
+
+	for (const imi_entry_t *e = b->head; e; e = e->next) {
+		const imi_entry_t *o;
+		uint32_t what = 0;
+
+		if (!e->key) {
+			if (!comments || __imi_find_section(b, e->parent) != e) continue;
+
+			o = __imi_find_section(a, e->parent);
+		} else {
+			if (__imi_find_entry(b, e->key) != e) continue;
+
+			if (!(o = __imi_find_entry(a, e->key))) what = IMI_DIFF_ADDED;
+			else if (!__imi_same(o->value, e->value)) what = IMI_DIFF_VALUE;
+		}
+
+		if (comments && o && !__imi_same(__imi_diff_comment(o), __imi_diff_comment(e))) what |= IMI_DIFF_COMMENT;
+
+		if (what && __imi_diff_push(d, what, o, e)) goto fail;
+	}
+
+	for (const imi_entry_t *e = a->head; e; e = e->next) {
+		if (!e->key || __imi_find_entry(a, e->key) != e || __imi_find_entry(b, e->key)) continue;
+
+		if (__imi_diff_push(d, IMI_DIFF_REMOVED, e, NULL)) goto fail;
+	}
+
+	return d;
+
+fail:
+	inimini_diff_free(d);
+
+	return NULL;
+}
+
+/* ============================================================================
+ * FRAGMENT DIRECTORIES (conf.d)
+ * Every "*.IMI_SUFFIXED" file in a directory is parsed into its own arena cfg by a small worker
+ * pool (one per online CPU, the caller included), then merged into cfg in lexical filename order,
+ * so later fragments win exactly as if they had been merged one by one.
+ * ========================================================================== */
+typedef struct {
+	char      path[4096];  /* Fragment file */
+	inimini_t *cfg;        /* Parsed fragment, NULL if it couldn't be read */
+} imi_fragment_t;
+
+typedef struct {
+	imi_fragment_t *frags; /* Fragments in lexical order */
+	size_t count;          /* Number of fragments */
+	size_t next;           /* Next fragment to claim (atomic) */
+	uint32_t flags;        /* Parse flags */
+} imi_fragjob_t;
+
+static inline int __imi_fragment_cmp(const void *a, const void *b) {
+	return strcmp(((const imi_fragment_t *)a)->path, ((const imi_fragment_t *)b)->path);
+}
+
+static inline void *__imi_fragment_work(void *arg) {
+	imi_fragjob_t *job = (imi_fragjob_t *)arg;
+	size_t i;
+
+	while ((i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->count) {
+		imi_fragment_t *f = &job->frags[i];
+
+		f->cfg = inimini_new_arena(0);
+
+		if (f->cfg && inimini_read(f->cfg, f->path, job->flags) < 0) {
+			inimini_free(f->cfg);
+
+			f->cfg = NULL;
+		}
+	}
+
+	return NULL;
+}
+
+/* Returns the number of fragments merged, -1 if the directory can't be read */
+static inline int inimini_read_dir(inimini_t *cfg, const char *dirpath, uint32_t flags) {
+	#if defined(_WIN32)
+		(void)cfg; (void)dirpath; (void)flags;
+
+		return -1;
+	#else
+		const char *suffix = "." IMI_SUFFIXED;
+		size_t slen = strlen(suffix), cap = 0;
+		imi_fragjob_t job = { NULL, 0, 0, flags };
+		DIR *dir = cfg && dirpath ? opendir(dirpath) : NULL;
+		struct dirent *d;
+
+		if (!dir) return -1;
+
+		while ((d = readdir(dir))) {
+			size_t nlen = strlen(d->d_name);
+
+			if (d->d_name[0] == '.' || nlen <= slen || strcmp(d->d_name + nlen - slen, suffix)) continue;
+
+			if (job.count == cap) {
+				imi_fragment_t *tmp = (imi_fragment_t *)realloc(job.frags, (cap = cap ? cap * 2 : 16) * sizeof(imi_fragment_t));
+
+				if (!tmp) break;
+
+				job.frags = tmp;
+			}
+
+			imi_fragment_t *f = &job.frags[job.count];
+
+			if (snprintf(f->path, sizeof(f->path), "%s/%s", dirpath, d->d_name) >= (int)sizeof(f->path)) continue;
+
+			f->cfg = NULL;
+			job.count++;
+		}
+
+		closedir(dir);
+
+		if (job.count > 1) qsort(job.frags, job.count, sizeof(imi_fragment_t), __imi_fragment_cmp);
+
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		size_t workers = cpus > 1 ? (size_t)cpus : 1;
+
+		if (workers > job.count) workers = job.count;
+
+		pthread_t *tid = workers > 1 ? (pthread_t *)calloc(workers - 1, sizeof(pthread_t)) : NULL;
+		size_t started = 0;
+
+		for (size_t i = 0; tid && i < workers - 1; i++) {
+			if (pthread_create(&tid[started], NULL, __imi_fragment_work, &job)) break;
+
+			started++;
+		}
+
+		__imi_fragment_work(&job);
+
+		for (size_t i = 0; i < started; i++) pthread_join(tid[i], NULL);
+
+		free(tid);
+
+		int merged = 0;
+
+		for (size_t i = 0; i < job.count; i++) {
+			if (!job.frags[i].cfg) continue;
+
+			if (!inimini_merge(cfg, job.frags[i].cfg, flags)) merged++;
+
+			inimini_free(job.frags[i].cfg);
+		}
+
+		free(job.frags);
+
+		return merged;
+	#endif
+}
+
+/* ============================================================================
+ * DATA ACCESSORS (GET)
+ * ========================================================================== */
+static inline const char *inimini_getstr(const inimini_t *cfg, const char *key, const char *def) {
+	const imi_entry_t *e = __imi_find_entry(cfg, key);
+
+	return e ? e->value : def;
+}
+
+/* Lazily fill the entry conversion cache. Values are parsed once per change; unchecked getters
+ * keep atoi/atof prefix semantics, the error bits feed the checked inimini_try* getters. The
+ * const getters write here, so concurrent reads of one cfg race - freeze it for that. */
+static inline void __imi_typed_int(imi_entry_t *e) {
+	if (e->typed & IMI_TYPED_INT) return;
+
+	char *end;
+
+	errno = 0;
+	e->ival = strtoll(e->value, &end, 10);
+
+	if (end == e->value || *end) e->typed |= IMI_TYPED_EINT;
+	else if (errno == ERANGE) e->typed |= IMI_TYPED_RINT;
+
+	e->typed |= IMI_TYPED_INT;
+}
+
+static inline void __imi_typed_dbl(imi_entry_t *e) {
+	if (e->typed & IMI_TYPED_DBL) return;
+
+	char *end;
+
+	errno = 0;
+	e->dval = strtod(e->value, &end);
+
+	if (end == e->value || *end) e->typed |= IMI_TYPED_EDBL;
+	else if (errno == ERANGE) e->typed |= IMI_TYPED_RDBL;
+
+	e->typed |= IMI_TYPED_DBL;
+}
+
+static inline void __imi_typed_bool(imi_entry_t *e) {
+	static const char *yes[] = { "true", "yes", "on", "1" };
+	static const char *no[] = { "false", "no", "off", "0" };
+
+	if (e->typed & IMI_TYPED_BOOL) return;
+
+	e->bval = 0;
+	e->typed |= IMI_TYPED_BOOL | IMI_TYPED_EBOOL;
+
+	for (size_t i = 0; i < sizeof(yes) / sizeof(*yes); i++) {
+		if (!strcasecmp(e->value, yes[i]) || !strcasecmp(e->value, no[i])) {
+			e->bval = !strcasecmp(e->value, yes[i]);
+			e->typed &= ~IMI_TYPED_EBOOL;
+
+			break;
+		}
+	}
+}
+
+static inline int inimini_getint(const inimini_t *cfg, const char *key, int def) {
+	imi_entry_t *e = __imi_find_entry(cfg, key);
+
+	if (!e || !e->value) return def;
+
+	__imi_typed_int(e);
+
+	return (int)e->ival;
+}
+
+static inline double inimini_getdbl(const inimini_t *cfg, const char *key, double def) {
+	imi_entry_t *e = __imi_find_entry(cfg, key);
+
+	if (!e || !e->value) return def;
+
+	__imi_typed_dbl(e);
+
+	return e->dval;
+}
+
+static inline int inimini_getbool(const inimini_t *cfg, const char *key, int def) {
+	imi_entry_t *e = __imi_find_entry(cfg, key);
+
+	if (!e || !e->value) return def;
+
+	__imi_typed_bool(e);
+
+	return e->typed & IMI_TYPED_EBOOL ? def : e->bval;
+}
+
+/* Checked getters: IMI_OK, IMI_ENOKEY, IMI_EINVAL or IMI_ERANGE instead of a silent default */
+static inline int inimini_htryint(imi_handle_t h, int64_t *out);
+static inline int inimini_htrydbl(imi_handle_t h, double *out);
+static inline int inimini_htrybool(imi_handle_t h, int *out);
+
+static inline int inimini_tryint(const inimini_t *cfg, const char *key, int64_t *out) {
+	return inimini_htryint(__imi_find_entry(cfg, key), out);
+}
+
+static inline int inimini_trydbl(const inimini_t *cfg, const char *key, double *out) {
+	return inimini_htrydbl(__imi_find_entry(cfg, key), out);
+}
+
+static inline int inimini_trybool(const inimini_t *cfg, const char *key, int *out) {
+	return inimini_htrybool(__imi_find_entry(cfg, key), out);
+}
+
+/* Next comma separated item of *cur, trimmed and non-empty (strtok rules) - NULL when done */
+static inline const char *__imi_next_item(const char **cur, size_t *len) {
+	const char *p = *cur;
+
+	while (p && *p) {
+		const char *end = strchr(p, ',');
+		const char *next = end ? end + 1 : p + strlen(p);
+
+		if (!end) end = next;
+
+		while (p < end && isspace((unsigned char)*p)) p++;
+		while (end > p && isspace((unsigned char)end[-1])) end--;
+
+		if (end > p) {
+			*cur = next;
+			*len = end - p;
+
+			return p;
+		}
+
+		p = next;
+	}
+
+	if (cur) *cur = p;
+
+	return NULL;
+}
+
+/* Split the value into one block: NULL terminated pointer table followed by the item strings.
+ * The value itself is left intact and the block is cached on the entry until the value changes. */
+static inline const char **inimini_getarr(const inimini_t *cfg, const char *key, const char **def) {
+	imi_entry_t *e = __imi_find_entry(cfg, key);
+
+	if (!e || !e->value) return def;
+
+	if (e->parsed) return (const char **)e->parsed;
+
+	const char *cur = e->value, *item;
+	size_t len, cnt = 0, bytes = 0;
+
+	while ((item = __imi_next_item(&cur, &len))) {
+		cnt++;
+		bytes += len + 1;
+	}
+
+	if (cnt == 0) return def;
+
+	char **arr = (char **)malloc((cnt + 1) * sizeof(char *) + bytes);
+
+	if (!arr) return def;
+
+	char *str = (char *)(arr + cnt + 1);
+
+	cur = e->value;
+
+	for (size_t i = 0; (item = __imi_next_item(&cur, &len)); i++) {
+		memcpy(str, item, len);
+
+		str[len] = '\0';
+		arr[i] = str;
+		str += len + 1;
+	}
+
+	arr[cnt] = NULL;
+	e->parsed = arr;
+
+	return (const char **)arr;
+}
+
+/* ARRAY ITERATOR: walks items in place, no allocation - items are views, not NUL terminated */
+typedef struct {
+	const char *cur;         /* Remaining unsplit value */
+} imi_arriter_t;
+
+static inline int inimini_arriter(const inimini_t *cfg, const char *key, imi_arriter_t *it) {
+	imi_entry_t *e = __imi_find_entry(cfg, key);
+
+	it->cur = e ? e->value : NULL;
+
+	return it->cur ? 0 : -1;
+}
+
+static inline const char *inimini_arrnext(imi_arriter_t *it, size_t *len) {
+	return __imi_next_item(&it->cur, len);
+}
+
+/* Section "" lists every section (in order of appearance), anything else lists the keys below
+ * it as leaf paths ("a" -> "b", "c.d"), section by section. Strings are borrowed from cfg and
+ * stay valid while their entries do; only the returned array is the caller's to free(). */
+static inline const char **inimini_getsub(const inimini_t *cfg, const char *section, size_t *count) {
+	if (!cfg || !count) {
+		if (count) *count = 0;
+
+		return NULL;
+	}
+
+	const char **items;
+	size_t cnt = 0;
+
+	*count = 0;
+
+	if (!section || !*section) {
+		if (!(items = (const char **)malloc((cfg->nsecs + 1) * sizeof(char *)))) return NULL;
+
+		for (const imi_node_t *n = cfg->secs; n; n = n->lnext) {
+			if (*n->path) items[cnt++] = n->path;
+		}
+	} else {
+		const imi_node_t *root = __imi_tree_get(cfg, section);
+		size_t slen = strlen(section);
+
+		if (!root || !root->keys) return NULL;
+
+		if (!(items = (const char **)malloc((root->keys + 1) * sizeof(char *)))) return NULL;
+
+		for (const imi_node_t *n = root; n; n = __imi_tree_next(root, n)) {
+			for (const imi_entry_t *e = n->first; e; e = e->snext) items[cnt++] = e->key + slen + 1;
+		}
+	}
+
+	items[cnt] = NULL;
+	*count = cnt;
+
+	return items;
+}
+
+static inline int inimini_hasval(const inimini_t *cfg, const char *key, const char *val) {
+	const imi_entry_t *e = __imi_find_entry(cfg, key);
+
+	if (e) return !e->value || !val || !strcmp(e->value, val);
+
+	return 0;
+}
+
+static inline int inimini_haskey(const inimini_t *cfg, const char *key) {
+	return __imi_find_entry(cfg, key) != NULL;
+}
+
+static inline int inimini_hassec(const inimini_t *cfg, const char *sect) {
+	const imi_node_t *n = sect ? __imi_tree_get(cfg, sect) : NULL;
+
+	return n && n->refs;
+}
+
+static inline size_t inimini_count(const inimini_t *cfg) {
+	return cfg->count;
+}
+
+/* ============================================================================
+ * KEY HANDLES
+ * Resolve a hot key once, then read it in O(1). Conversions are cached on the entry and redone
+ * only after the value changes, so repeated numeric reads skip both the lookup and atoi/atof.
+ * ========================================================================== */
+static inline imi_handle_t inimini_handle(const inimini_t *cfg, const char *key) {
+	return __imi_find_entry(cfg, key);
+}
+
+/* Same, with hash == __imi_hash(key) precomputed (e.g. at compile time by a wrapper) */
+static inline imi_handle_t inimini_handle_hashed(const inimini_t *cfg, const char *key, uint64_t hash) {
+	if (!key || !cfg->cap) return __imi_find_entry(cfg, key);
+
+	return __imi_index_find(cfg, key, hash, 0);
+}
+
+static inline const char *inimini_hgetstr(imi_handle_t h, const char *def) {
+	return h && h->value ? h->value : def;
+}
+
+static inline int inimini_hgetint(imi_handle_t h, int def) {
+	if (!h || !h->value) return def;
+
+	__imi_typed_int(h);
+
+	return (int)h->ival;
+}
+
+static inline double inimini_hgetdbl(imi_handle_t h, double def) {
+	if (!h || !h->value) return def;
+
+	__imi_typed_dbl(h);
+
+	return h->dval;
+}
+
+static inline int inimini_hgetbool(imi_handle_t h, int def) {
+	if (!h || !h->value) return def;
+
+	__imi_typed_bool(h);
+
+	return h->typed & IMI_TYPED_EBOOL ? def : h->bval;
+}
+
+static inline int inimini_htryint(imi_handle_t h, int64_t *out) {
+	if (!h) return IMI_ENOKEY;
+
+	if (!h->value) return IMI_EINVAL;
+
+	__imi_typed_int(h);
+
+	if (h->typed & IMI_TYPED_EINT) return IMI_EINVAL;
+
+	*out = h->ival;
+
+	return h->typed & IMI_TYPED_RINT ? IMI_ERANGE : IMI_OK;
+}
+
+static inline int inimini_htrydbl(imi_handle_t h, double *out) {
+	if (!h) return IMI_ENOKEY;
+
+	if (!h->value) return IMI_EINVAL;
+
+	__imi_typed_dbl(h);
+
+	if (h->typed & IMI_TYPED_EDBL) return IMI_EINVAL;
+
+	*out = h->dval;
+
+	return h->typed & IMI_TYPED_RDBL ? IMI_ERANGE : IMI_OK;
+}
+
+static inline int inimini_htrybool(imi_handle_t h, int *out) {
+	if (!h) return IMI_ENOKEY;
+
+	if (!h->value) return IMI_EINVAL;
+
+	__imi_typed_bool(h);
+
+	if (h->typed & IMI_TYPED_EBOOL) return IMI_EINVAL;
+
+	*out = h->bval;
+
+	return IMI_OK;
+}
+
+/* ============================================================================
+ * BULK LOOKUPS
+ * Resolve a batch of keys in stages instead of one full probe at a time: hash IMI_BATCH keys and
+ * prefetch their home slots, then the entries those slots name, then the entry keys, and only
+ * then probe and compare. The cache misses of a batch overlap instead of queueing. out[] carries
+ * the defaults in - a missing or unconvertible key leaves its slot untouched. Each call returns
+ * the number of keys found.
+ * ========================================================================== */
+#if defined(__GNUC__) || defined(__clang__)
+#define __IMI_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define __IMI_PREFETCH(p) ((void)(p))
+#endif
+
+static inline size_t inimini_handles(const inimini_t *cfg, const char *const *keys, size_t n, imi_handle_t *out) {
+	size_t found = 0;
+
+	for (size_t base = 0; base < n; base += IMI_BATCH) {
+		size_t m = n - base < IMI_BATCH ? n - base : IMI_BATCH;
+		uint64_t hash[IMI_BATCH];
+		const imi_entry_t *near[IMI_BATCH];
+
+		if (cfg->cap) {
+			for (size_t i = 0; i < m; i++) {
+				hash[i] = keys[base + i] ? __imi_hash(keys[base + i]) : 0;
+
+				__IMI_PREFETCH(&cfg->slots[hash[i] & (cfg->cap - 1)]);
+			}
+
+			/* Home slots are arriving: start on the entries whose stored hash matches */
+			for (size_t i = 0; i < m; i++) {
+				const imi_slot_t *s = &cfg->slots[hash[i] & (cfg->cap - 1)];
+
+				near[i] = s->entry && s->entry != __IMI_TOMB && s->hash == hash[i] ? s->entry : NULL;
+
+				if (near[i]) __IMI_PREFETCH(near[i]);
+			}
+
+			/* Then on their keys, so the strcmp below finds them cached */
+			for (size_t i = 0; i < m; i++) {
+				if (near[i]) __IMI_PREFETCH(near[i]->key);
+			}
+		}
+
+		for (size_t i = 0; i < m; i++) {
+			const char *key = keys[base + i];
+			imi_entry_t *e = NULL;
+
+			if (key) e = cfg->cap ? __imi_index_find(cfg, key, hash[i], 0) : __imi_find_entry(cfg, key);
+
+			if (e) {
+				__IMI_PREFETCH(e->value);
+
+				found++;
+			}
+
+			out[base + i] = e;
+		}
+	}
+
+	return found;
+}
+
+static inline size_t inimini_getmany(const inimini_t *cfg, const char *const *keys, size_t n, const char **out) {
+	imi_handle_t h[IMI_BATCH];
+	size_t found = 0;
+
+	for (size_t base = 0; base < n; base += IMI_BATCH) {
+		size_t m = n - base < IMI_BATCH ? n - base : IMI_BATCH;
+
+		found += inimini_handles(cfg, keys + base, m, h);
+
+		for (size_t i = 0; i < m; i++) {
+			if (h[i]) out[base + i] = h[i]->value;
+		}
+	}
+
+	return found;
+}
+
+static inline size_t inimini_getmany_int(const inimini_t *cfg, const char *const *keys, size_t n, int *out) {
+	imi_handle_t h[IMI_BATCH];
+	size_t found = 0;
+
+	for (size_t base = 0; base < n; base += IMI_BATCH) {
+		size_t m = n - base < IMI_BATCH ? n - base : IMI_BATCH;
+
+		found += inimini_handles(cfg, keys + base, m, h);
+
+		for (size_t i = 0; i < m; i++) {
+			int64_t v;
+
+			if (inimini_htryint(h[i], &v) == IMI_OK && v >= INT_MIN && v <= INT_MAX) out[base + i] = (int)v;
+		}
+	}
+
+	return found;
+}
+
+static inline size_t inimini_getmany_dbl(const inimini_t *cfg, const char *const *keys, size_t n, double *out) {
+	imi_handle_t h[IMI_BATCH];
+	size_t found = 0;
+
+	for (size_t base = 0; base < n; base += IMI_BATCH) {
+		size_t m = n - base < IMI_BATCH ? n - base : IMI_BATCH;
+
+		found += inimini_handles(cfg, keys + base, m, h);
+
+		for (size_t i = 0; i < m; i++) {
+			double v;
+
+			if (inimini_htrydbl(h[i], &v) == IMI_OK) out[base + i] = v;
+		}
+	}
+
+	return found;
+}
+
+static inline size_t inimini_getmany_bool(const inimini_t *cfg, const char *const *keys, size_t n, int *out) {
+	imi_handle_t h[IMI_BATCH];
+	size_t found = 0;
+
+	for (size_t base = 0; base < n; base += IMI_BATCH) {
+		size_t m = n - base < IMI_BATCH ? n - base : IMI_BATCH;
+
+		found += inimini_handles(cfg, keys + base, m, h);
+
+		for (size_t i = 0; i < m; i++) inimini_htrybool(h[i], &out[base + i]);
+	}
+
+	return found;
+}
+
+/* ============================================================================
+ * STRUCT BINDING
+ * A descriptor table maps keys onto struct fields; inimini_bind fills the struct in one batched
+ * sweep. Defaults are config text converted by the same rules as the values, and conversion
+ * failures are reported per field (IMI_EINVAL / IMI_ERANGE) while the field takes the default.
+ * A binder keeps a stamp per field so a rebind after reload only rewrites fields whose text
+ * changed. STR fields borrow from cfg and must be rebound before the old cfg is freed.
+ * ========================================================================== */
+typedef struct {
+	const char *key;     /* Full dotted key */
+	int type;            /* IMI_BIND_* */
+	size_t offset;       /* offsetof(struct, field) */
+	const char *def;     /* Default as config text, NULL leaves the field alone when missing */
+} imi_bind_t;
+
+#define IMI_BIND(type, st, field, key, def) { key, type, offsetof(st, field), def }
+
+typedef struct {
+	const imi_bind_t *desc;  /* Borrowed descriptor table */
+	size_t n;                /* Descriptor count */
+	int *status;             /* Per field result of the last pass: IMI_OK / ENOKEY / EINVAL / ERANGE */
+	uint64_t *stamps;        /* Per field hash of the text last bound */
+	const inimini_t *cfg;    /* Config STR fields point into */
+	int bound;               /* 0 until the first pass */
+	size_t errors;           /* EINVAL / ERANGE count of the last pass */
+} inimini_binder_t;
+
+/* Convert one value into its field. NULL entry means missing, then def is converted instead. */
+static inline int __imi_bind_field(const imi_bind_t *d, imi_entry_t *e, void *obj) {
+	imi_entry_t tmp;
+	char *field = (char *)obj + d->offset;
+	int st = e ? IMI_OK : IMI_ENOKEY;
+
+	if (!e || !e->value) {
+		if (e) st = IMI_EINVAL;
+
+		if (!d->def) return st;
+
+		memset(&tmp, 0, sizeof(tmp));
+
+		tmp.value = (char *)d->def;
+		e = &tmp;
+	}
+
+	switch (d->type) {
+	case IMI_BIND_STR:
+		*(const char **)field = e->value;
+
+		return st;
+	case IMI_BIND_INT:
+	case IMI_BIND_I64:
+		__imi_typed_int(e);
+
+		if (e->typed & IMI_TYPED_EINT) break;
+
+		if (d->type == IMI_BIND_I64) {
+			*(int64_t *)field = e->ival;
+		} else {
+			*(int *)field = e->ival > INT_MAX ? INT_MAX : e->ival < INT_MIN ? INT_MIN : (int)e->ival;
+
+			if (e->ival > INT_MAX || e->ival < INT_MIN) return st ? st : IMI_ERANGE;
+		}
+
+		return st ? st : e->typed & IMI_TYPED_RINT ? IMI_ERANGE : IMI_OK;
+	case IMI_BIND_DBL:
+		__imi_typed_dbl(e);
+
+		if (e->typed & IMI_TYPED_EDBL) break;
+
+		*(double *)field = e->dval;
+
+		return st ? st : e->typed & IMI_TYPED_RDBL ? IMI_ERANGE : IMI_OK;
+	case IMI_BIND_BOOL:
+		__imi_typed_bool(e);
+
+		if (e->typed & IMI_TYPED_EBOOL) break;
+
+		*(int *)field = e->bval;
+
+		return st;
+	default:
+		return IMI_EINVAL;
+	}
+
+	/* Unconvertible: fall back to the default once, a bad default leaves the field alone */
+	if (e != &tmp && d->def) __imi_bind_field(d, NULL, obj);
+
+	return IMI_EINVAL;
+}
+
+static inline int __imi_bind_failed(int st) {
+	return st == IMI_EINVAL || st == IMI_ERANGE;
+}
+
+/* Resolve the keys of desc[base..base+m) in one batched probe */
+static inline void __imi_bind_lookup(const inimini_t *cfg, const imi_bind_t *desc, size_t m, imi_handle_t *h) {
+	const char *keys[IMI_BATCH];
+
+	for (size_t i = 0; i < m; i++) keys[i] = desc[i].key;
+
+	inimini_handles(cfg, keys, m, h);
+}
+
+/* One-shot: fill obj from cfg. status (optional, n ints) receives each field result.
+ * Returns the number of fields that failed to convert. */
+static inline int inimini_bind(const inimini_t *cfg, const imi_bind_t *desc, size_t n, void *obj, int *status) {
+	imi_handle_t h[IMI_BATCH];
+	int errors = 0;
+
+	for (size_t base = 0; base < n; base += IMI_BATCH) {
+		size_t m = n - base < IMI_BATCH ? n - base : IMI_BATCH;
+
+		__imi_bind_lookup(cfg, desc + base, m, h);
+
+		for (size_t i = 0; i < m; i++) {
+			int st = __imi_bind_field(&desc[base + i], h[i], obj);
+
+			if (status) status[base + i] = st;
+
+			errors += __imi_bind_failed(st);
+		}
+	}
+
+	return errors;
+}
+
+static inline inimini_binder_t *inimini_binder_new(const imi_bind_t *desc, size_t n) {
+	inimini_binder_t *b = (inimini_binder_t *)calloc(1, sizeof(inimini_binder_t));
+
+	if (!b) return NULL;
+
+	b->desc = desc;
+	b->n = n;
+	b->status = (int *)calloc(n ? n : 1, sizeof(int));
+	b->stamps = (uint64_t *)calloc(n ? n : 1, sizeof(uint64_t));
+
+	if (!b->status || !b->stamps) {
+		free(b->status);
+		free(b->stamps);
+		free(b);
+
+		return NULL;
+	}
+
+	return b;
+}
+
+/* Bind obj from cfg, skipping fields whose text is unchanged since the last pass (the first pass
+ * binds all). Returns the number of fields rewritten; b->status and b->errors describe the pass. */
+static inline int inimini_rebind(inimini_binder_t *b, const inimini_t *cfg, void *obj) {
+	imi_handle_t h[IMI_BATCH];
+	int moved = b->cfg != cfg;
+	int touched = 0;
+
+	b->errors = 0;
+
+	for (size_t base = 0; base < b->n; base += IMI_BATCH) {
+		size_t m = b->n - base < IMI_BATCH ? b->n - base : IMI_BATCH;
+
+		__imi_bind_lookup(cfg, b->desc + base, m, h);
+
+		for (size_t i = 0; i < m; i++) {
+			const imi_bind_t *d = &b->desc[base + i];
+			uint64_t stamp = !h[i] ? 0 : h[i]->value ? __imi_hash(h[i]->value) : 1;
+
+			if (b->bound && stamp == b->stamps[base + i]) {
+				/* Same text, but a STR view must follow the new cfg */
+				if (moved && d->type == IMI_BIND_STR && h[i]) __imi_bind_field(d, h[i], obj);
+			} else {
+				b->status[base + i] = __imi_bind_field(d, h[i], obj);
+				b->stamps[base + i] = stamp;
+
+				touched++;
+			}
+
+			b->errors += __imi_bind_failed(b->status[base + i]);
+		}
+	}
+
+	b->cfg = cfg;
+	b->bound = 1;
+
+	return touched;
+}
+
+static inline void inimini_binder_free(inimini_binder_t *b) {
+	if (!b) return;
+
+	free(b->status);
+	free(b->stamps);
+	free(b);
+}
+
+/* ============================================================================
+ * KEY SCHEMAS
+ * For binaries that read a fixed, known key set. List the keys once as an X-macro:
+ *
+ *   #define APP_KEYS(X) X(DB_HOST, "db.host") X(DB_PORT, "db.port")
+ *
+ *   enum { APP_KEYS(IMI_SCHEMA_ID) APP_NKEYS };
+ *   static const char *const app_keys[] = { APP_KEYS(IMI_SCHEMA_KEY) };
+ *
+ * inimini_schema_new() searches perfect-hash seeds for the list once at startup. A cfg with the
+ * schema attached files every schema key into a fixed array as it is parsed (or set, merged,
+ * removed), so inimini_sget(cfg, DB_PORT) is a plain array load - no hashing, no strcmp.
+ * ========================================================================== */
+#define IMI_SCHEMA_ID(id, key)  id,
+#define IMI_SCHEMA_KEY(id, key) key,
+
+/* Find a seed that sends every key of one bucket to a distinct free slot. Identical hashes never
+ * separate, so duplicate keys exhaust the tries. */
+static inline int __imi_schema_place(imi_schema_t *s, const size_t *ids, size_t k, size_t *at, uint32_t *seed) {
+	for (uint32_t d = 0; d < IMI_SCHEMA_TRIES; d++) {
+		size_t i = 0;
+
+		for (; i < k; i++) {
+			size_t j = 0;
+
+			at[i] = __imi_schema_mix(s->hashes[ids[i]], d) & s->mask;
+
+			while (j < i && at[j] != at[i]) j++;
+
+			if (j < i || s->slots[at[i]] >= 0) break;
+		}
+
+		if (i == k) {
+			for (i = 0; i < k; i++) s->slots[at[i]] = (int32_t)ids[i];
+
+			*seed = d;
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Build a perfect hash for keys[0..n) (borrowed, must be unique). NULL on duplicates or OOM. */
+static inline imi_schema_t *inimini_schema_new(const char *const *keys, size_t n) {
+	size_t m = 2, r = 1;
+
+	while (m < n * 2) m <<= 1;
+
+	while (r * 4 < n) r <<= 1;
+
+	imi_schema_t *s = (imi_schema_t *)calloc(1, sizeof(imi_schema_t) + n * sizeof(uint64_t) + r * sizeof(uint32_t) + m * sizeof(int32_t));
+	size_t *start = (size_t *)calloc(r + 1, sizeof(size_t));
+	size_t *ids = (size_t *)malloc((n ? n : 1) * 2 * sizeof(size_t));
+
+	if (!s || !start || !ids) {
+		free(s);
+		free(start);
+		free(ids);
+
+		return NULL;
+	}
+
+	s->keys = keys;
+	s->n = n;
+	s->mask = m - 1;
+	s->bmask = r - 1;
+	s->hashes = (uint64_t *)(s + 1);
+	s->seeds = (uint32_t *)(s->hashes + n);
+	s->slots = (int32_t *)(s->seeds + r);
+
+	memset(s->slots, 0xff, m * sizeof(int32_t));
+
+	/* Group key ids by bucket: start[b]..start[b + 1] in ids */
+	for (size_t i = 0; i < n; i++) {
+		s->hashes[i] = __imi_hash(keys[i]);
+
+		start[((s->hashes[i] >> 32) & s->bmask) + 1]++;
+	}
+
+	size_t most = 0;
+
+	for (size_t b = 0; b < r; b++) {
+		if (start[b + 1] > most) most = start[b + 1];
+
+		start[b + 1] += start[b];
+	}
+
+	size_t *at = ids + n;
+
+	for (size_t i = 0; i < n; i++) ids[start[(s->hashes[i] >> 32) & s->bmask]++] = i;
+
+	for (size_t b = r; b > 0; b--) start[b] = start[b - 1];
+
+	start[0] = 0;
+
+	/* Place the fullest buckets first, while the table is emptiest */
+	int ok = 1;
+
+	for (size_t size = most; ok && size; size--) {
+		for (size_t b = 0; ok && b < r; b++) {
+			if (start[b + 1] - start[b] == size) ok = __imi_schema_place(s, ids + start[b], size, at, &s->seeds[b]);
+		}
+	}
+
+	free(start);
+	free(ids);
+
+	if (!ok) {
+		free(s);
+
+		return NULL;
+	}
+
+	return s;
+}
+
+static inline void inimini_schema_free(imi_schema_t *s) {
+	free(s);
+}
+
+/* Schema id of key, -1 when the schema does not list it */
+static inline int inimini_schema_find(const imi_schema_t *s, const char *key) {
+	return key ? __imi_schema_find(s, key, __imi_hash(key)) : -1;
+}
+
+/* Attach schema to cfg (NULL detaches) and file the keys it already holds. The schema must
+ * outlive cfg or be detached first. */
+static inline int inimini_use_schema(inimini_t *cfg, const imi_schema_t *schema) {
+	imi_entry_t **fixed = NULL;
+
+	if (schema && !(fixed = (imi_entry_t **)calloc(schema->n ? schema->n : 1, sizeof(imi_entry_t *)))) return -1;
+
+	free(cfg->fixed);
+
+	cfg->schema = schema;
+	cfg->fixed = fixed;
+
+	if (fixed) {
+		for (imi_entry_t *e = cfg->head; e; e = e->next) {
+			if (e->key) __imi_schema_add(cfg, e);
+		}
+	}
+
+	return 0;
+}
+
+/* inimini_load with schema attached first: keys are filed while the layers are parsed */
+static inline int inimini_load_schema(inimini_t *cfg, const char *progname, const imi_schema_t *schema, uint32_t flags) {
+	if (inimini_use_schema(cfg, schema)) return 0;
+
+	return inimini_load(cfg, progname, flags);
+}
+
+/* Constant-index reads - id must be below the attached schema's n */
+static inline imi_handle_t inimini_sget(const inimini_t *cfg, size_t id) {
+	return cfg->fixed[id];
+}
+
+static inline const char *inimini_sgetstr(const inimini_t *cfg, size_t id, const char *def) {
+	return inimini_hgetstr(cfg->fixed[id], def);
+}
+
+static inline int inimini_sgetint(const inimini_t *cfg, size_t id, int def) {
+	return inimini_hgetint(cfg->fixed[id], def);
+}
+
+static inline double inimini_sgetdbl(const inimini_t *cfg, size_t id, double def) {
+	return inimini_hgetdbl(cfg->fixed[id], def);
+}
+
+static inline int inimini_sgetbool(const inimini_t *cfg, size_t id, int def) {
+	return inimini_hgetbool(cfg->fixed[id], def);
+}
+
+/* ============================================================================
+ * ITERATORS
+ * Cursor over borrowed entry views, no heap use. all walks the list in file order, section the
+ * keys directly under one section, prefix every key below a dotted prefix. Section markers are
+ * skipped. Views follow the entry rules: valid until the entry is changed or removed, and the
+ * config must not be modified while a cursor is open.
+ * ========================================================================== */
+typedef struct {
+	const char *key;          /* Current full key */
+	const char *value;        /* Current value (may be NULL) */
+	const char *comment;      /* Current comment (may be NULL or "") */
+	const char *parent;       /* Current section */
+	const imi_entry_t *entry; /* Next entry to yield */
+	const imi_node_t *root;   /* Subtree root (prefix mode) */
+	const imi_node_t *node;   /* Node of entry (prefix mode) */
+	int tree;                 /* 0 = list order, 1 = section chain */
+} imi_iter_t;
+
+static inline void inimini_iter_all(const inimini_t *cfg, imi_iter_t *it) {
+	memset(it, 0, sizeof(*it));
+
+	it->entry = cfg ? cfg->head : NULL;
+}
+
+static inline void inimini_iter_section(const inimini_t *cfg, const char *section, imi_iter_t *it) {
+	memset(it, 0, sizeof(*it));
+
+	it->tree = 1;
+	it->node = cfg && section ? __imi_tree_get(cfg, section) : NULL;
+	it->entry = it->node ? it->node->first : NULL;
+}
+
+static inline void inimini_iter_prefix(const inimini_t *cfg, const char *prefix, imi_iter_t *it) {
+	inimini_iter_section(cfg, prefix, it);
+
+	it->root = it->node;
+}
+
+static inline int inimini_iter_next(imi_iter_t *it) {
+	const imi_entry_t *e = it->entry;
+
+	if (it->tree) {
+		while (!e && it->root && it->node && (it->node = __imi_tree_next(it->root, it->node))) e = it->node->first;
+
+		if (!e) return 0;
+
+		it->entry = e->snext;
+	} else {
+		while (e && !e->key) e = e->next;
+
+		if (!e) return 0;
+
+		it->entry = e->next;
+	}
+
+	it->key = e->key;
+	it->value = e->value;
+	it->comment = e->comment;
+	it->parent = e->parent;
+
+	return 1;
+}
+
+/* ============================================================================
+ * DATA MODIFICATION (SET)
+ * ========================================================================== */
+static inline imi_entry_t *__imi_set(inimini_t *cfg, const char *key, const char *val) {
+	imi_entry_t *e = __imi_find_entry(cfg, key);
+
+	if (e) {
+		int same = __imi_same(e->value, val);
+
+		__imi_set_value(cfg, e, val);
+
+		if (!same) __imi_notify(cfg, e->key, e->value);
+
+		return e;
+	}
+
+	e = (imi_entry_t *)__imi_alloc(cfg, sizeof(imi_entry_t));
+
+	if (!e) return NULL;
+
+	e->key = __imi_extract_key(cfg, key);
+	e->value = __imi_strdup(cfg, val);
+	e->parent = __imi_extract_parent(cfg, e->key);
+
+	__imi_list_append(cfg, e);
+
+	return e;
+}
+
+static inline int inimini_setstr(inimini_t *cfg, const char *key, const char *val) {
+	return __imi_set(cfg, key, val) ? 0 : -1;
+}
+
+/* Numeric setters prime the conversion cache, the next typed read is a plain load */
+static inline int inimini_setint(inimini_t *cfg, const char *key, int val) {
+	char buf[64];
+
+	snprintf(buf, sizeof(buf), "%d", val);
+
+	imi_entry_t *e = __imi_set(cfg, key, buf);
+
+	if (!e) return -1;
+
+	e->ival = val;
+	e->dval = val;
+	e->typed = IMI_TYPED_INT | IMI_TYPED_DBL;
+
+	return 0;
+}
+
+static inline int inimini_setdbl(inimini_t *cfg, const char *key, double val) {
+	char buf[64];
+
+	snprintf(buf, sizeof(buf), "%.6g", val);
+
+	imi_entry_t *e = __imi_set(cfg, key, buf);
+
+	if (!e) return -1;
+
+	e->dval = strtod(buf, NULL);
+	e->typed = IMI_TYPED_DBL;
+
+	return 0;
+}
+
+static inline int inimini_setarr(inimini_t *cfg, const char *key, char **val, size_t count) {
+	char buf[4096] = "";
+	size_t off = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		size_t len = strlen(val[i]);
+
+		if (off + len + 2 > sizeof(buf)) break;
+
+		off += sprintf(buf + off, "%s%s", i > 0 ? ", " : "", val[i]);
+	}
+
+	return inimini_setstr(cfg, key, buf);
+}
+
+static inline int inimini_remove(inimini_t *cfg, const char *key) {
+	imi_entry_t *found = __imi_find_entry(cfg, key);
+	imi_entry_t *prev = NULL;
+
+	if (!found) return -1;
+
+	for (imi_entry_t *e = cfg->head; e; e = e->next) {
+		if (e == found) {
+			if (prev) prev->next = e->next;
+			else cfg->head = e->next;
+
+			if (e == cfg->tail) cfg->tail = prev;
+
+			cfg->count--;
+
+			__imi_index_del(cfg, e);
+			__imi_tree_del(cfg, e);
+
+			/* A later duplicate may have been promoted in its place */
+			const imi_entry_t *now = __imi_find_entry(cfg, key);
+
+			if (!__imi_same(e->value, now ? now->value : NULL)) __imi_notify(cfg, key, now ? now->value : NULL);
+			__imi_free_entry(cfg, e);
+
+			return 0;
+		}
+
+		prev = e;
+	}
+
+	return -1;
+}
+
+static inline int inimini_clear(inimini_t *cfg) {
+	while (cfg->head) {
+		imi_entry_t *e = cfg->head;
+		cfg->head = e->next;
+
+		if (cfg->head == NULL) cfg->tail = NULL;
+
+		__imi_free_entry(cfg, e);
+	}
+
+	__imi_arena_free(cfg);
+	__imi_blocks_free(cfg);
+	__imi_sources_free(cfg);
+	__imi_tree_free(cfg);
+
+	free(cfg->slots);
+
+	cfg->slots = NULL;
+	cfg->count = cfg->cap = cfg->used = 0;
+
+	/* The schema stays attached, its slots now point at nothing */
+	if (cfg->fixed) memset(cfg->fixed, 0, cfg->schema->n * sizeof(*cfg->fixed));
+
+	return 0;
 }
 
-static inline int inimini_read(inimini_t *cfg, const char *filepath, uint32_t flags) {
-	FILE *f = fopen(filepath, "r");
+static inline int inimini_comment(inimini_t *cfg, const char *key, const char *comment) {
+	imi_entry_t *e = __imi_find_entry(cfg, key);
 
-	if (!f) return -1;
+	if (!e) return -1;
 
-	int ret = __imi_parse(cfg, f, flags);
+	__imi_release(cfg, e->comment);
 
-	fclose(f);
+	e->comment = __imi_strdup(cfg, comment);
 
-	return ret;
+	return 0;
 }
 
-static inline int inimini_load(inimini_t *cfg, const char *progname, uint32_t flags) {
-	int loaded = 0;
-	FILE *f;
+/* ============================================================================
+ * FROZEN SNAPSHOTS
+ * inimini_freeze() flattens a cfg into one immutable, position-independent blob: header, entry
+ * table, hash slots, pre-split arrays and strings, all addressed by offset. Numbers are converted
+ * and arrays split up front, so readers never write anything - any number of threads may read a
+ * snapshot with no locks or atomics. Only the first entry of a duplicated key is kept (the one
+ * inimini_getstr() would return); section markers are dropped.
+ * ========================================================================== */
+#define IMI_FROZEN_MAGIC   0x494d4946u  /* "FIMI" */
+#define IMI_FROZEN_VERSION 2
 
-	f = inimini_sysconf(progname, "r");
+#define IMI_FROZEN_INT     0x0001       /* Whole value parsed as an integer */
+#define IMI_FROZEN_DBL     0x0002       /* Whole value parsed as a double */
 
-	if (f) {
-		__imi_parse(cfg, f, flags);
-		fclose(f);
+typedef struct {
+	uint32_t magic;    /* IMI_FROZEN_MAGIC */
+	uint32_t version;  /* IMI_FROZEN_VERSION */
+	uint64_t size;     /* Total blob bytes */
+	uint32_t count;    /* Entries */
+	uint32_t cap;      /* Hash slots, power of two */
+	uint32_t entries;  /* Offset of imi_frozen_entry_t[count] */
+	uint32_t slots;    /* Offset of uint32_t[cap], entry index + 1 (0 = empty) */
+} imi_frozen_hdr_t;
+
+typedef struct {
+	uint64_t hash;     /* __imi_hash(key) */
+	uint32_t key;      /* String offsets, 0 = NULL */
+	uint32_t value;
+	uint32_t comment;
+	uint32_t parent;
+	uint32_t arr;      /* Offset of uint32_t[arrc] element string offsets */
+	uint32_t arrc;     /* Array element count */
+	uint32_t flags;    /* IMI_FROZEN_INT | IMI_FROZEN_DBL */
+	uint32_t reserved;
+	int64_t  ival;     /* strtoll(value) prefix, as inimini_getint() reads it */
+	double   dval;     /* strtod(value) prefix, as inimini_getdbl() reads it */
+} imi_frozen_entry_t;
+
+typedef struct {
+	const unsigned char *base;  /* Blob, starts with imi_frozen_hdr_t */
+	size_t size;                /* Blob bytes (whole mapping when mapped) */
+	int    mapped;              /* 1 = munmap on free, 0 = free */
+} inimini_frozen_t;
+
+/* Growable blob under construction, failures latch data to NULL */
+typedef struct {
+	unsigned char *data;
+	size_t len;
+	size_t cap;
+} imi_buf_t;
+
+static inline size_t __imi_buf_reserve(imi_buf_t *b, size_t n, size_t align) {
+	if (!b->data) return 0;
 
-		loaded++;
+	size_t off = (b->len + align - 1) & ~(align - 1);
+
+	if (off + n > b->cap) {
+		size_t cap = b->cap ? b->cap : 4096;
+
+		while (cap < off + n) cap *= 2;
+
+		unsigned char *tmp = (unsigned char *)realloc(b->data, cap);
+
+		if (!tmp) {
+			free(b->data);
+
+			b->data = NULL;
+
+			return 0;
+		}
+
+		b->data = tmp;
+		b->cap = cap;
 	}
 
-	f = inimini_usrconf(progname, "r");
+	memset(b->data + b->len, 0, off + n - b->len);
 
-	if (f) {
-		__imi_parse(cfg, f, flags);
-		fclose(f);
+	b->len = off + n;
+
+	return off;
+}
+
+static inline uint32_t __imi_buf_str(imi_buf_t *b, const char *s, size_t len) {
+	if (!s) return 0;
+
+	size_t off = __imi_buf_reserve(b, len + 1, 1);
+
+	if (off) memcpy(b->data + off, s, len);
+
+	return (uint32_t)off;
+}
+
+static inline void __imi_freeze_entry(imi_buf_t *b, size_t slot, const imi_entry_t *e) {
+	imi_frozen_entry_t fe;
+	const char *v = e->value;
+	size_t vlen = v ? strlen(v) : 0;
+
+	memset(&fe, 0, sizeof(fe));
+
+	fe.hash = __imi_hash(e->key);
+	fe.key = __imi_buf_str(b, e->key, strlen(e->key));
+	fe.value = v ? __imi_buf_str(b, v, vlen) : 0;
+	fe.comment = e->comment ? __imi_buf_str(b, e->comment, strlen(e->comment)) : 0;
+	fe.parent = e->parent ? __imi_buf_str(b, e->parent, strlen(e->parent)) : 0;
+
+	if (v && *v) {
+		char *end;
+
+		fe.ival = strtoll(v, &end, 10);
+
+		if (!*end) fe.flags |= IMI_FROZEN_INT;
+
+		fe.dval = strtod(v, &end);
+
+		if (!*end) fe.flags |= IMI_FROZEN_DBL;
+
+		const char *cur = v, *item;
+		size_t len;
+
+		while (__imi_next_item(&cur, &len)) fe.arrc++;
+
+		fe.arr = fe.arrc ? (uint32_t)__imi_buf_reserve(b, fe.arrc * sizeof(uint32_t), sizeof(uint32_t)) : 0;
+
+		cur = v;
+
+		for (uint32_t i = 0; fe.arr && (item = __imi_next_item(&cur, &len)); i++) {
+			uint32_t off = len == vlen ? fe.value : __imi_buf_str(b, item, len);
+
+			if (b->data) memcpy(b->data + fe.arr + i * sizeof(uint32_t), &off, sizeof(off));
+		}
+	}
+
+	if (b->data) memcpy(b->data + slot, &fe, sizeof(fe));
+}
 
-		loaded++;
+/* Snapshot cfg into a fresh immutable blob. Returns NULL on allocation failure. */
+static inline inimini_frozen_t *inimini_freeze(const inimini_t *cfg) {
+	if (!cfg) return NULL;
+
+	uint32_t count = 0, cap = 8;
+
+	for (const imi_entry_t *e = cfg->head; e; e = e->next) {
+		if (e->key && __imi_find_entry(cfg, e->key) == e) count++;
 	}
 
+	while (cap < count * 2) cap <<= 1;
 
-	f = inimini_dirconf(progname, "r");
+	imi_buf_t b = { (unsigned char *)malloc(4096), 0, 4096 };
 
-	if (f) {
-		__imi_parse(cfg, f, flags);
+	__imi_buf_reserve(&b, sizeof(imi_frozen_hdr_t), 8);
+
+	size_t entries = __imi_buf_reserve(&b, count * sizeof(imi_frozen_entry_t), 8);
+	size_t slots = __imi_buf_reserve(&b, cap * sizeof(uint32_t), 8);
+	uint32_t i = 0;
+
+	for (const imi_entry_t *e = cfg->head; e && b.data; e = e->next) {
+		if (!e->key || __imi_find_entry(cfg, e->key) != e) continue;
+
+		__imi_freeze_entry(&b, entries + i * sizeof(imi_frozen_entry_t), e);
+
+		uint32_t *table = (uint32_t *)(b.data + slots);
+		size_t j = __imi_hash(e->key) & (cap - 1);
+
+		while (table[j]) j = (j + 1) & (cap - 1);
+
+		table[j] = ++i;
+	}
+
+	/* Closing NUL: any string offset inside the blob is terminated inside it */
+	__imi_buf_reserve(&b, 1, 1);
+
+	inimini_frozen_t *snap = b.data && b.len <= UINT32_MAX ? (inimini_frozen_t *)malloc(sizeof(inimini_frozen_t)) : NULL;
+
+	if (!snap) {
+		free(b.data);
+
+		return NULL;
+	}
+
+	imi_frozen_hdr_t *h = (imi_frozen_hdr_t *)b.data;
+
+	h->magic = IMI_FROZEN_MAGIC;
+	h->version = IMI_FROZEN_VERSION;
+	h->size = b.len;
+	h->count = count;
+	h->cap = cap;
+	h->entries = (uint32_t)entries;
+	h->slots = (uint32_t)slots;
+
+	snap->base = b.data;
+	snap->size = b.len;
+	snap->mapped = 0;
+
+	return snap;
+}
+
+static inline void inimini_frozen_free(inimini_frozen_t *snap) {
+	if (!snap) return;
+
+#if !defined(_WIN32)
+	if (snap->mapped) munmap((void *)snap->base, snap->size);
+	else free((void *)snap->base);
+#else
+	free((void *)snap->base);
+#endif
+
+	free(snap);
+}
+
+/* Check a blob read from outside before trusting its offsets: every table, string and array in
+ * bounds, and at least one empty slot so probes terminate. One pass over entries and slots. */
+static inline int __imi_frozen_valid(const unsigned char *base, size_t size) {
+	const imi_frozen_hdr_t *h = (const imi_frozen_hdr_t *)base;
+
+	if (size < sizeof(*h) || h->magic != IMI_FROZEN_MAGIC || h->version != IMI_FROZEN_VERSION) return 0;
+
+	if (h->size != size || base[size - 1] || !h->cap || (h->cap & (h->cap - 1)) || h->count >= h->cap) return 0;
+
+	if (h->entries % 8 || h->entries < sizeof(*h) || h->entries + (uint64_t)h->count * sizeof(imi_frozen_entry_t) > size) return 0;
+
+	if (h->slots % 4 || h->slots < sizeof(*h) || h->slots + (uint64_t)h->cap * sizeof(uint32_t) > size) return 0;
+
+	const uint32_t *table = (const uint32_t *)(base + h->slots);
+	uint32_t used = 0;
+
+	for (uint32_t i = 0; i < h->cap; i++) {
+		if (table[i] > h->count) return 0;
+
+		used += table[i] != 0;
+	}
+
+	if (used != h->count) return 0;
+
+	const imi_frozen_entry_t *entries = (const imi_frozen_entry_t *)(base + h->entries);
+
+	for (uint32_t i = 0; i < h->count; i++) {
+		const imi_frozen_entry_t *fe = &entries[i];
+
+		if (!fe->key || fe->key >= size || fe->value >= size || fe->comment >= size || fe->parent >= size) return 0;
+
+		if (!fe->arrc) continue;
+
+		if (fe->arr % 4 || fe->arr < sizeof(*h) || fe->arr + (uint64_t)fe->arrc * sizeof(uint32_t) > size) return 0;
+
+		const uint32_t *arr = (const uint32_t *)(base + fe->arr);
+
+		for (uint32_t j = 0; j < fe->arrc; j++) {
+			if (arr[j] >= size) return 0;
+		}
+	}
+
+	return 1;
+}
+
+static inline const char *__imi_frozen_str(const inimini_frozen_t *snap, uint32_t off) {
+	return off ? (const char *)snap->base + off : NULL;
+}
+
+static inline const imi_frozen_entry_t *__imi_frozen_find(const inimini_frozen_t *snap, const char *key, uint64_t hash) {
+	if (!snap || !key) return NULL;
+
+	const imi_frozen_hdr_t *h = (const imi_frozen_hdr_t *)snap->base;
+	const imi_frozen_entry_t *entries = (const imi_frozen_entry_t *)(snap->base + h->entries);
+	const uint32_t *slots = (const uint32_t *)(snap->base + h->slots);
+
+	for (size_t i = hash & (h->cap - 1); slots[i]; i = (i + 1) & (h->cap - 1)) {
+		const imi_frozen_entry_t *fe = &entries[slots[i] - 1];
+
+		if (fe->hash == hash && !strcmp(__imi_frozen_str(snap, fe->key), key)) return fe;
+	}
+
+	return NULL;
+}
+
+static inline const char *inimini_frozen_getstr(const inimini_frozen_t *snap, const char *key, const char *def) {
+	const imi_frozen_entry_t *fe = __imi_frozen_find(snap, key, key ? __imi_hash(key) : 0);
+
+	return fe ? __imi_frozen_str(snap, fe->value) : def;
+}
+
+static inline int inimini_frozen_getint(const inimini_frozen_t *snap, const char *key, int def) {
+	const imi_frozen_entry_t *fe = __imi_frozen_find(snap, key, key ? __imi_hash(key) : 0);
+
+	return fe && fe->value ? (int)fe->ival : def;
+}
+
+static inline double inimini_frozen_getdbl(const inimini_frozen_t *snap, const char *key, double def) {
+	const imi_frozen_entry_t *fe = __imi_frozen_find(snap, key, key ? __imi_hash(key) : 0);
+
+	return fe && fe->value ? fe->dval : def;
+}
+
+/* Copy up to max borrowed element pointers into out, returns the total element count */
+static inline size_t inimini_frozen_getarr(const inimini_frozen_t *snap, const char *key, const char **out, size_t max) {
+	const imi_frozen_entry_t *fe = __imi_frozen_find(snap, key, key ? __imi_hash(key) : 0);
+
+	if (!fe) return 0;
+
+	for (uint32_t i = 0; i < fe->arrc && i < max; i++) {
+		uint32_t off;
+
+		memcpy(&off, snap->base + fe->arr + i * sizeof(uint32_t), sizeof(off));
+
+		out[i] = __imi_frozen_str(snap, off);
+	}
+
+	return fe->arrc;
+}
+
+static inline int inimini_frozen_haskey(const inimini_frozen_t *snap, const char *key) {
+	return __imi_frozen_find(snap, key, key ? __imi_hash(key) : 0) != NULL;
+}
+
+static inline int inimini_frozen_hasval(const inimini_frozen_t *snap, const char *key, const char *val) {
+	const imi_frozen_entry_t *fe = __imi_frozen_find(snap, key, key ? __imi_hash(key) : 0);
+
+	if (fe) return !fe->value || !val || !strcmp(__imi_frozen_str(snap, fe->value), val);
+
+	return 0;
+}
+
+static inline size_t inimini_frozen_count(const inimini_frozen_t *snap) {
+	return snap ? ((const imi_frozen_hdr_t *)snap->base)->count : 0;
+}
+
+/* ============================================================================
+ * COMPILED CACHE
+ * inimini_load_frozen() keeps the frozen blob of a program's load stack on disk, followed by a
+ * trailer recording the stamp (path hash, size, mtime, inode) of each layer and of every file
+ * they include or tried to include (absent = zero stamp), plus value hashes of the variables
+ * they expanded and of the repository includeIf conditions saw. When every stamp still matches,
+ * startup is one stat per file plus a read-only mmap - no parsing, no copies.
+ * Otherwise the stack is loaded, frozen and the cache rewritten atomically. The cache lives in
+ * the user cache dir (sources span /etc, home and cwd, so "next to" them is not writable).
+ * ========================================================================== */
+#define IMI_CACHE_MAGIC  0x43494d49u  /* "IMIC" */
+
+/* Default compiled cache suffix appended after IMI_SUFFIXED */
+#ifndef IMI_CACHE_SUFFIX
+#define IMI_CACHE_SUFFIX "imc"
+#endif
+
+typedef struct {
+	uint32_t    magic;      /* IMI_CACHE_MAGIC */
+	uint32_t    flags;      /* Load flags the blob was built with */
+	uint64_t    blob;       /* Frozen blob bytes, the include records follow them */
+	uint64_t    extra;      /* Include record bytes, the trailer follows them */
+	imi_stamp_t layers[3];  /* System, user, dir */
+} imi_cache_t;
+
+/* Source record: the stamp a source was parsed with, its kind byte, then its NUL-terminated
+ * path or variable name padded to 8 bytes. Layers are stamped before loading; includes and
+ * variables are only known after, so their stamps are the ones taken while parsing. */
+static inline size_t __imi_cache_record(const imi_source_t *src) {
+	return sizeof(imi_stamp_t) + ((strlen(src->path) + 9) & ~(size_t)7);
+}
+
+/* 1 if every source record in [p, end) still matches */
+static inline int __imi_cache_fresh(const unsigned char *p, const unsigned char *end) {
+	while (p < end) {
+		imi_stamp_t want, now;
+
+		if ((size_t)(end - p) < sizeof(want) + 8) return 0;
+
+		memcpy(&want, p, sizeof(want));
+
+		const char *path = (const char *)p + sizeof(want) + 1;
+		const char *nul = (const char *)memchr(path, '\0', (size_t)(end - p) - sizeof(want) - 1);
+
+		if (!nul) return 0;
+
+		size_t len = (size_t)(nul - path);
+
+		__imi_source_stamp(p[sizeof(want)], path, &now);
+
+		if (memcmp(&want, &now, sizeof(now))) return 0;
+
+		p += sizeof(want) + ((len + 9) & ~(size_t)7);
+	}
+
+	return 1;
+}
+
+static inline void __imi_cache_stamps(const char *progname, imi_stamp_t layers[3]) {
+	char path[4096];
+
+	__imi_syspath(progname, path, sizeof(path));
+	__imi_stamp(path, &layers[0]);
+	__imi_usrpath(progname, path, sizeof(path));
+	__imi_stamp(path, &layers[1]);
+	__imi_dirpath(progname, path, sizeof(path));
+	__imi_stamp(path, &layers[2]);
+
+	/* The dir layer is cwd relative, so tie its stamp to the working directory too */
+	char cwd[4096];
+
+	if (layers[2].path && getcwd(cwd, sizeof(cwd))) layers[2].path = (__imi_hash(cwd) ^ layers[2].path) | 1;
+}
+
+static inline int __imi_cachepath(const char *progname, char *path, size_t size) {
+	path[0] = '\0';
+
+	#if defined(_WIN32)
+		char *dir = getenv("LOCALAPPDATA");
+
+		if (dir) snprintf(path, size, "%s\\%s.%s.%s", dir, progname, IMI_SUFFIXED, IMI_CACHE_SUFFIX);
+	#else
+		char *xdg = getenv("XDG_CACHE_HOME");
+		char *home = getenv("HOME");
+
+		if (xdg && *xdg) snprintf(path, size, "%s/%s.%s.%s", xdg, progname, IMI_SUFFIXED, IMI_CACHE_SUFFIX);
+		else if (home) snprintf(path, size, "%s/.cache/%s.%s.%s", home, progname, IMI_SUFFIXED, IMI_CACHE_SUFFIX);
+	#endif
+
+	return path[0] ? 0 : -1;
+}
+
+/* Map a cache file and accept it only if it is intact and stamped with exactly these layers */
+static inline inimini_frozen_t *__imi_cache_open(const char *path, const imi_cache_t *want) {
+#if defined(_WIN32)
+	(void)path;
+	(void)want;
+
+	return NULL;
+#else
+	FILE *f = fopen(path, "rb");
+	struct stat st;
+
+	if (!f) return NULL;
+
+	if (fstat(fileno(f), &st) || (size_t)st.st_size < sizeof(imi_frozen_hdr_t) + sizeof(imi_cache_t)) {
 		fclose(f);
 
-		loaded++;
+		return NULL;
 	}
 
-	return loaded;
+	size_t size = (size_t)st.st_size;
+	void *m = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(f), 0);
+
+	fclose(f);
+
+	if (m == MAP_FAILED) return NULL;
+
+	const imi_frozen_hdr_t *h = (const imi_frozen_hdr_t *)m;
+	imi_cache_t c;
+
+	memcpy(&c, (const unsigned char *)m + size - sizeof(imi_cache_t), sizeof(c));
+
+	int ok = c.magic == IMI_CACHE_MAGIC && c.blob == h->size && c.blob <= size - sizeof(c) && c.extra == size - sizeof(c) - c.blob &&
+		c.flags == want->flags && !memcmp(c.layers, want->layers, sizeof(c.layers)) &&
+		__imi_frozen_valid((const unsigned char *)m, (size_t)c.blob) &&
+		__imi_cache_fresh((const unsigned char *)m + c.blob, (const unsigned char *)m + c.blob + c.extra);
+
+	inimini_frozen_t *snap = ok ? (inimini_frozen_t *)malloc(sizeof(inimini_frozen_t)) : NULL;
+
+	if (!snap) {
+		munmap(m, size);
+
+		return NULL;
+	}
+
+	snap->base = (const unsigned char *)m;
+	snap->size = size;
+	snap->mapped = 1;
+
+	return snap;
+#endif
+}
+
+/* Write blob + include records + trailer to a temp file and rename it over the cache, best effort */
+static inline void __imi_cache_store(const char *path, const inimini_frozen_t *snap, const imi_source_t *sources, imi_cache_t *c) {
+	char tmp[4200];
+	char dir[4096];
+
+	snprintf(dir, sizeof(dir), "%s", path);
+
+	char *slash = strrchr(dir, '/');
+
+	if (slash) {
+		*slash = '\0';
+
+		#if !defined(_WIN32)
+			mkdir(dir, 0755);
+		#endif
+	}
+
+	snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+
+	FILE *f = fopen(tmp, "wb");
+
+	if (!f) return;
+
+	c->blob = snap->size;
+	c->extra = 0;
+
+	int ok = fwrite(snap->base, 1, snap->size, f) == snap->size;
+
+	for (const imi_source_t *src = sources; src && ok; src = src->next) {
+		char pad[8] = { 0 };
+		size_t len = strlen(src->path) + 1;
+		size_t rec = __imi_cache_record(src);
+
+		ok = fwrite(&src->stamp, sizeof(src->stamp), 1, f) == 1 && fputc(src->kind, f) != EOF &&
+			fwrite(src->path, 1, len, f) == len &&
+			fwrite(pad, 1, rec - sizeof(src->stamp) - 1 - len, f) == rec - sizeof(src->stamp) - 1 - len;
+
+		c->extra += rec;
+	}
+
+	ok = ok && fwrite(c, sizeof(*c), 1, f) == 1;
+
+	if (fclose(f) || !ok || rename(tmp, path)) remove(tmp);
+}
+
+/* Frozen snapshot of the inimini_load() stack, served from the compiled cache when fresh */
+static inline inimini_frozen_t *inimini_load_frozen(const char *progname, uint32_t flags) {
+	char path[4096];
+	imi_cache_t want;
+
+	memset(&want, 0, sizeof(want));
+
+	want.magic = IMI_CACHE_MAGIC;
+	want.flags = flags;
+
+	/* Stamp before loading: a layer edited mid-load leaves a stale stamp and rebuilds next time */
+	__imi_cache_stamps(progname, want.layers);
+
+	int cached = !__imi_cachepath(progname, path, sizeof(path));
+	inimini_frozen_t *snap = cached ? __imi_cache_open(path, &want) : NULL;
+
+	if (snap) return snap;
+
+	inimini_t *cfg = inimini_new_arena(0);
+
+	if (!cfg) return NULL;
+
+	inimini_load(cfg, progname, flags);
+
+	snap = inimini_freeze(cfg);
+
+	if (snap && cached) __imi_cache_store(path, snap, cfg->sources, &want);
+
+	inimini_free(cfg);
+
+	return snap;
 }
 
 /* ============================================================================
- * WRITE LOGIC (FLAG-BASED FORMATTING)
+ * HOT RELOAD (RCU STYLE)
+ * A reload handle re-runs the inimini_load() stack into a fresh cfg, freezes it and publishes
+ * the snapshot with an atomic pointer swap. Readers register once, then bracket reads with
+ * enter/leave: two atomic stores and a load, never a lock. Replaced snapshots are retired with
+ * the epoch of their replacement and freed once every active reader has moved past it.
+ * Reloads are serialized by the handle; call inimini_reload() from a thread, not from a signal
+ * handler (set a flag on SIGHUP instead).
  * ========================================================================== */
-static inline void __imi_write_header(FILE *f, const char *parent, uint32_t flags) {
-	if (!parent || !*parent) return;
+#ifndef IMI_READERS
+#define IMI_READERS      64    /* Reader slots of inimini_reload_new(), see inimini_reload_new_sized() */
+#endif
+
+typedef struct imi_retired {
+	struct imi_retired *next;  /* Older retired snapshot */
+	inimini_frozen_t   *snap;  /* Snapshot waiting for its grace period */
+	uint64_t           epoch;  /* Epoch that replaced it */
+} imi_retired_t;
+
+typedef struct {
+	char             *progname;              /* inimini_load() program name */
+	uint32_t         flags;                  /* inimini_load() flags */
+	inimini_frozen_t *current;               /* Published snapshot (atomic) */
+	uint64_t         epoch;                  /* Global epoch, starts at 1 (atomic) */
+	size_t           readers;                /* Reader slots, fixed at creation */
+	uint64_t         *active;                /* Epoch seen by each reader inside a read, 0 = quiescent */
+	int              *claimed;               /* Reader slot ownership (atomic) */
+	int              busy;                   /* Reload in progress (atomic) */
+	imi_retired_t    *retired;               /* Snapshots pending reclamation, newest first */
+	imi_subnode_t    *subs;                  /* Prefix subscriptions, fired by inimini_reload() */
+} inimini_reload_t;
+
+static inline inimini_frozen_t *__imi_reload_build(inimini_reload_t *h, int *loaded) {
+	inimini_t *cfg = inimini_new_arena(0);
+
+	if (!cfg) return NULL;
+
+	*loaded = inimini_load(cfg, h->progname, h->flags);
+
+	inimini_frozen_t *snap = inimini_freeze(cfg);
+
+	inimini_free(cfg);
+
+	return snap;
+}
 
-	if (flags & IMI_GITSTYLE) {
-		if (strchr(parent, ' ')) fprintf(f, "[%s \"%s\"]\n", parent, parent);
-		else fprintf(f, "[%s]\n", parent);
-	} else {
-		fprintf(f, "[%s]\n", parent);
+/* Fire subscriptions for keys whose value differs between two snapshots */
+static inline void __imi_reload_notify(const imi_subnode_t *subs, const inimini_frozen_t *a, const inimini_frozen_t *b) {
+	for (int pass = 0; subs && pass < 2; pass++) {
+		const inimini_frozen_t *from = pass ? a : b, *to = pass ? b : a;
+		const imi_frozen_hdr_t *h = (const imi_frozen_hdr_t *)from->base;
+		const imi_frozen_entry_t *entries = (const imi_frozen_entry_t *)(from->base + h->entries);
+
+		for (uint32_t i = 0; i < h->count; i++) {
+			const char *key = __imi_frozen_str(from, entries[i].key);
+			const imi_frozen_entry_t *o = __imi_frozen_find(to, key, entries[i].hash);
+
+			/* Second pass only reports keys that disappeared */
+			if (pass) {
+				if (!o) __imi_subs_fire(subs, key, NULL);
+			} else if (!o || !__imi_same(__imi_frozen_str(to, o->value), __imi_frozen_str(from, entries[i].value))) {
+				__imi_subs_fire(subs, key, __imi_frozen_str(from, entries[i].value));
+			}
+		}
 	}
 }
 
-static inline int __imi_write(const inimini_t *cfg, FILE *f, uint32_t flags) {
-	if (!f) return -1;
+/* Free retired snapshots no active reader can still see. Caller holds busy. */
+static inline size_t __imi_reload_reclaim(inimini_reload_t *h) {
+	uint64_t oldest = UINT64_MAX;
+	size_t pending = 0;
 
-	const imi_entry_t *prev = NULL;
-	const char *prev_parent = "";
-	int printed_sections = 0;
-	int write_indent = (flags & IMI_GITSTYLE) ? 1 : 0;
+	for (size_t i = 0; i < h->readers; i++) {
+		uint64_t e = __atomic_load_n(&h->active[i], __ATOMIC_SEQ_CST);
 
-	for (const imi_entry_t *e = cfg->head; e; e = e->next) {
-		const char *current_parent = e->parent ? e->parent : "";
+		if (e && e < oldest) oldest = e;
+	}
 
-		/* Blank line before new section group */
-		if (prev_parent && strcmp(current_parent, prev_parent) && printed_sections) fprintf(f, "\n");
+	for (imi_retired_t **r = &h->retired; *r; ) {
+		if ((*r)->epoch <= oldest) {
+			imi_retired_t *done = *r;
 
-		/* Print section header on change */
-		if (!prev || (prev_parent && strcmp(current_parent, prev_parent))) {
-			__imi_write_header(f, current_parent, flags);
+			*r = done->next;
 
-			printed_sections++;
+			inimini_frozen_free(done->snap);
+			free(done);
+		} else {
+			pending++;
+			r = &(*r)->next;
 		}
+	}
 
-		/* Section marker (key == NULL) */
-		if (e->key == NULL) {
-			if (e->comment && (flags & IMI_COMMENTS)) fprintf(f, "; %s\n", e->comment);
-		} else {
-			const char *child = e->key;
-			const char *dot = e->key;
-			int dot_count = 0;
+	return pending;
+}
 
-			while (dot_count < IMI_DOTDEPTH - 1) {
-				dot = strchr(dot + 1, '.');
+/* Reload handle with room for readers threads (0 = IMI_READERS). The slot table lives in the
+ * same allocation as the handle and never moves, so enter/leave stay a plain indexed store. */
+static inline inimini_reload_t *inimini_reload_new_sized(const char *progname, uint32_t flags, size_t readers) {
+	if (!readers) readers = IMI_READERS;
 
-				if (!dot) break;
+	if (readers > (SIZE_MAX - sizeof(inimini_reload_t)) / (sizeof(uint64_t) + sizeof(int))) return NULL;
 
-				dot_count++;
-			}
+	inimini_reload_t *h = (inimini_reload_t *)calloc(1, sizeof(inimini_reload_t) + readers * (sizeof(uint64_t) + sizeof(int)));
 
-			if (dot) child = dot + 1;
+	if (!h) return NULL;
 
-			/* Apply indent for GITSTYLE */
-			if (write_indent) fprintf(f, "\t%s = %s", child, e->value);
-			else fprintf(f, "%s = %s", child, e->value);
+	int loaded = 0;
 
-			/* Handle comments */
-			if (e->comment && (flags & IMI_COMMENTS)) fprintf(f, "\n; %s", e->comment);
+	h->readers = readers;
+	h->active = (uint64_t *)(h + 1);
+	h->claimed = (int *)(h->active + readers);
 
-			fprintf(f, "\n");
-		}
+	h->progname = strdup(progname);
+	h->flags = flags & ~(uint32_t)IMI_MMAP;
+	h->epoch = 1;
+	h->current = h->progname ? __imi_reload_build(h, &loaded) : NULL;
 
-		prev_parent = current_parent;
-		prev = e;
-	}
+	if (!h->current) {
+		free(h->progname);
+		free(h);
 
+		return NULL;
+	}
 
-	return 0;
+	return h;
 }
 
-static inline int inimini_write(const inimini_t *cfg, const char *path, uint32_t flags) {
-	FILE *f = fopen(path, "w");
-	int r = __imi_write(cfg, f, flags);
+static inline inimini_reload_t *inimini_reload_new(const char *progname, uint32_t flags) {
+	return inimini_reload_new_sized(progname, flags, 0);
+}
 
-	fclose(f);
+/* Rebuild and publish. Returns layers loaded (the old snapshot stays published when none could
+ * be read), -1 when another reload is running or memory ran out. */
+static inline int inimini_reload(inimini_reload_t *h) {
+	if (__atomic_exchange_n(&h->busy, 1, __ATOMIC_ACQUIRE)) return -1;
 
-	return r;
-}
+	int loaded = 0;
+	inimini_frozen_t *snap = __imi_reload_build(h, &loaded);
+	imi_retired_t *r = snap && loaded ? (imi_retired_t *)malloc(sizeof(imi_retired_t)) : NULL;
+	int ret = snap ? loaded : -1;
 
-/* ============================================================================
- * MERGE LOGIC
- * ========================================================================== */
-static inline int inimini_merge(inimini_t *base, const inimini_t *overlay, uint32_t flags) {
-	const imi_entry_t *o = overlay->head;
+	if (!r) {
+		inimini_frozen_free(snap);
 
-	while (o) {
-		imi_entry_t *b = __imi_find_entry(base, o->key);
+		if (snap && loaded) ret = -1;
+	} else {
+		r->snap = __atomic_exchange_n(&h->current, snap, __ATOMIC_SEQ_CST);
+		r->epoch = __atomic_add_fetch(&h->epoch, 1, __ATOMIC_SEQ_CST);
+		r->next = h->retired;
 
-		if (b) {
-			free(b->value);
+		h->retired = r;
 
-			b->value = strdup(o->value);
+		__imi_reload_notify(h->subs, r->snap, snap);
+	}
 
-			if ((flags & IMI_COMMENTS) && o->comment) {
-				if (o->key == NULL && b->comment && o->comment) {
-					size_t blen = strlen(b->comment);
-					size_t olen = strlen(o->comment);
-					char *combined = realloc(b->comment, blen + olen + 4);
+	__imi_reload_reclaim(h);
 
-					if (combined) {
-					    strcat(combined, " | ");
-					    strcat(combined, o->comment);
+	__atomic_store_n(&h->busy, 0, __ATOMIC_RELEASE);
 
-					    b->comment = combined;
-					}
-				} else {
-					free(b->comment);
+	return ret;
+}
 
-					b->comment = strdup(o->comment);
-				}
-			}
-		} else {
-			imi_entry_t *entry = calloc(1, sizeof(imi_entry_t));
-			entry->key = strdup(o->key);
-			entry->value = strdup(o->value);
-			entry->parent = o->parent ? strdup(o->parent) : strdup("");
-			entry->comment = o->comment ? strdup(o->comment) : NULL;
+/* Prefix subscription fired from inimini_reload() after the new snapshot is published. Register
+ * before reloads start: the list itself is not synchronized. */
+static inline int inimini_reload_subscribe(inimini_reload_t *h, const char *prefix, imi_sub_fn fn, void *ctx) {
+	return __imi_subs_add(&h->subs, prefix, fn, ctx);
+}
 
-			__imi_list_append(base, entry);
-		}
+/* Claim a reader slot for the calling thread, -1 when all slots are taken */
+static inline int inimini_reload_register(inimini_reload_t *h) {
+	for (int i = 0; (size_t)i < h->readers && i < INT_MAX; i++) {
+		int expected = 0;
 
-		o = o->next;
+		if (__atomic_compare_exchange_n(&h->claimed[i], &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) return i;
 	}
 
-	return 0;
+	return -1;
 }
 
-/* ============================================================================
- * DATA ACCESSORS (GET)
- * ========================================================================== */
-static inline const char *inimini_getstr(const inimini_t *cfg, const char *key, const char *def) {
-	for (const imi_entry_t *e = cfg->head; e; e = e->next) {
-		if (e->key && !strcmp(e->key, key)) return e->value;
-	}
-
-	return def;
+static inline void inimini_reload_unregister(inimini_reload_t *h, int reader) {
+	__atomic_store_n(&h->active[reader], 0, __ATOMIC_SEQ_CST);
+	__atomic_store_n(&h->claimed[reader], 0, __ATOMIC_RELEASE);
 }
 
-static inline int inimini_getint(const inimini_t *cfg, const char *key, int def) {
-	const char *v = inimini_getstr(cfg, key, NULL);
+/* Pin the current snapshot until inimini_reload_leave(). Never blocks. */
+static inline const inimini_frozen_t *inimini_reload_enter(inimini_reload_t *h, int reader) {
+	__atomic_store_n(&h->active[reader], __atomic_load_n(&h->epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
 
-	return v ? atoi(v) : def;
+	return __atomic_load_n(&h->current, __ATOMIC_SEQ_CST);
 }
 
-static inline double inimini_getdbl(const inimini_t *cfg, const char *key, double def) {
-	const char *v = inimini_getstr(cfg, key, NULL);
-
-	return v ? atof(v) : def;
+static inline void inimini_reload_leave(inimini_reload_t *h, int reader) {
+	__atomic_store_n(&h->active[reader], 0, __ATOMIC_RELEASE);
 }
 
-static inline const char **inimini_getarr(const inimini_t *cfg, const char *key, const char **def) {
-	size_t cap = 64, cnt = 0;
-	char **parsed = calloc(cap, sizeof(char*));
+/* Retry reclamation outside a reload, returns snapshots still waiting on readers */
+static inline size_t inimini_reload_reclaim(inimini_reload_t *h) {
+	if (__atomic_exchange_n(&h->busy, 1, __ATOMIC_ACQUIRE)) return 0;
 
-	if (!parsed) return def;
+	size_t pending = __imi_reload_reclaim(h);
 
-	for (imi_entry_t *e = cfg->head; e; e = e->next) {
-		if (e->key && !strcmp(e->key, key)) {
-			char *tmp = e->value;
+	__atomic_store_n(&h->busy, 0, __ATOMIC_RELEASE);
+
+	return pending;
+}
 
-			if (e->parsed) return (const char**)e->parsed;
+/* Readers must be gone - frees every snapshot regardless of epochs */
+static inline void inimini_reload_free(inimini_reload_t *h) {
+	if (!h) return;
 
-			if (!tmp) {
-				free(parsed);
+	while (h->retired) {
+		imi_retired_t *next = h->retired->next;
 
-				return def;
-			}
+		inimini_frozen_free(h->retired->snap);
+		free(h->retired);
 
-			char *tok = strtok(tmp, ",");
+		h->retired = next;
+	}
 
-			while (tok && cnt < cap - 1) { /* Leave room for NULL terminator */
-				char *trimmed = tok;
+	inimini_frozen_free(h->current);
+	__imi_subs_free(h->subs);
+	free(h->progname);
+	free(h);
+}
 
-				while (isspace((unsigned char)*trimmed)) trimmed++;
+/* ============================================================================
+ * FILE WATCHER
+ * Keeps the inimini_load() stack as three layer configs plus the combined cfg, and watches the
+ * layer files and everything they include. inotify on the containing directories (so editors
+ * that save by rename are seen) only wakes the watcher; (size, mtime, inode) stamps decide what
+ * changed, and are polled every IMI_WATCH_POLL ms where inotify is missing or a directory can't
+ * be watched. Bursts are coalesced until the stamps hold still for IMI_WATCH_DEBOUNCE ms, then
+ * only the changed layers are re-parsed, the stack is recombined in load order and callbacks
+ * get the keys whose effective value appeared, changed or disappeared.
+ * ========================================================================== */
+#ifndef IMI_WATCH_DEBOUNCE
+#define IMI_WATCH_DEBOUNCE 50
+#endif
 
-				char *end = trimmed + strlen(trimmed) - 1;
+#ifndef IMI_WATCH_POLL
+#define IMI_WATCH_POLL   500
+#endif
 
-				while (end > trimmed && isspace((unsigned char)*end)) *end-- = '\0';
+/* keys are valid for the duration of the call, cfg until the next change */
+typedef void (*imi_watch_fn)(const inimini_t *cfg, const char *const *keys, size_t count, void *ctx);
 
-				if (*trimmed) parsed[cnt++] = trimmed;
+typedef struct {
+	imi_watch_fn fn;         /* Change callback */
+	void        *ctx;        /* Callback context */
+} imi_watch_cb_t;
 
-				tok = strtok(NULL, ",");
-			}
+typedef struct {
+	char        *path;       /* Watched file (may not exist yet) */
+	int         layer;       /* 0 = system, 1 = user, 2 = dir */
+	imi_stamp_t stamp;       /* Last seen state */
+} imi_watch_file_t;
 
-			e->parsed = parsed;
+typedef struct {
+	char             *progname;  /* inimini_load() program name */
+	uint32_t         flags;      /* inimini_load() flags */
+	inimini_t        *layers[3]; /* Parsed system, user and dir layers */
+	inimini_t        *cfg;       /* Layers combined in load order */
+	imi_watch_file_t *files;     /* Layer files and their includes */
+	size_t           nfiles;     /* Watched files */
+	imi_watch_cb_t   *cbs;       /* Registered callbacks */
+	size_t           ncbs;       /* Callback count */
+	int              fd;         /* inotify descriptor, -1 = stamp polling only */
+	int              *wds;       /* inotify watches on the directories of files */
+	size_t           nwds;       /* Watch descriptors held */
+	int              polling;    /* Some directory couldn't be watched, poll stamps too */
+} inimini_watch_t;
+
+static inline inimini_t *__imi_watch_parse(inimini_watch_t *w, int layer) {
+	void (*const resolve[3])(const char *, char *, size_t) = { __imi_syspath, __imi_usrpath, __imi_dirpath };
+	inimini_t *cfg = inimini_new();
+	char path[4096];
+
+	if (!cfg) return NULL;
+
+	resolve[layer](w->progname, path, sizeof(path));
+
+	FILE *f = fopen(path, "r");
 
-			break;
-		}
+	if (f) {
+		__imi_parse(cfg, f, w->flags, path);
+		fclose(f);
 	}
 
-	if (cnt == 0) {
-		free(parsed);
+	return cfg;
+}
+
+/* Stamps of files already watched are carried over from old, so edits made while a layer was
+ * being re-parsed still show up on the next check */
+static inline int __imi_watch_add(inimini_watch_t *w, const char *path, int layer, size_t *cap, const imi_watch_file_t *old, size_t nold) {
+	if (!*path) return 0;
+
+	if (w->nfiles == *cap) {
+		imi_watch_file_t *tmp = (imi_watch_file_t *)realloc(w->files, (*cap = *cap ? *cap * 2 : 8) * sizeof(imi_watch_file_t));
 
-		return def;
+		if (!tmp) return -1;
+
+		w->files = tmp;
 	}
 
-	parsed[cnt] = NULL;
+	imi_watch_file_t *f = &w->files[w->nfiles];
 
-	return (const char **)parsed;
-}
+	if (!(f->path = strdup(path))) return -1;
 
-static inline char **inimini_getsub(inimini_t *cfg, const char *section, size_t *count) {
-	if (!cfg || !count) {
-		if (count) *count = 0;
+	f->layer = layer;
 
-		return NULL;
-	}
+	size_t i = 0;
 
-	size_t cap = 64;
-	size_t cnt = 0;
-	char **items = calloc(cap, sizeof(char*));
+	while (i < nold && strcmp(old[i].path, path)) i++;
 
-	if (!section || strlen(section) == 0) {
-		for (imi_entry_t *e = cfg->head; e; e = e->next) {
-			const char *parent = e->parent;
+	if (i < nold) f->stamp = old[i].stamp;
+	else __imi_stamp(path, &f->stamp);
 
-			if (!parent || !*parent) continue;
+	w->nfiles++;
 
-			int found = 0;
+	#if defined(__linux__)
+		char dir[4096];
+		const char *slash = strrchr(path, '/');
 
-			for (size_t i = 0; i < cnt; i++) {
-				if (strcmp(items[i], parent) == 0) {
-					found = 1;
+		if (slash) snprintf(dir, sizeof(dir), "%.*s", slash == path ? 1 : (int)(slash - path), path);
+		else snprintf(dir, sizeof(dir), ".");
 
-					break;
-				}
-			}
+		int wd = w->fd < 0 ? -1 : inotify_add_watch(w->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ATTRIB);
 
-			if (!found) {
-				if (cnt >= cap) {
-					cap *= 2;
+		if (wd < 0) {
+			w->polling = 1;
 
-					char **tmp = realloc(items, cap * sizeof(char*));
+			return 0;
+		}
 
-					if (!tmp) {
-						for (size_t i = 0; i < cnt; i++) free(items[i]);
+		/* Every file in a directory shares its watch descriptor */
+		for (size_t j = 0; j < w->nwds; j++) {
+			if (w->wds[j] == wd) return 0;
+		}
 
-						free(items);
+		int *tmp = (int *)realloc(w->wds, (w->nwds + 1) * sizeof(int));
 
-						*count = 0;
+		if (!tmp) return -1;
 
-						return NULL;
-					}
+		w->wds = tmp;
+		w->wds[w->nwds++] = wd;
+	#else
+		w->polling = 1;
+	#endif
 
-					items = tmp;
-				}
+	return 0;
+}
 
-				items[cnt++] = strdup(parent);
-			}
-		}
-	} else {
-		size_t slen = strlen(section);
+/* Rebuild the watch list from the layer paths and the includes recorded while parsing */
+static inline int __imi_watch_files(inimini_watch_t *w) {
+	void (*const resolve[3])(const char *, char *, size_t) = { __imi_syspath, __imi_usrpath, __imi_dirpath };
+	imi_watch_file_t *old = w->files;
+	int *oldwds = w->wds;
+	size_t nold = w->nfiles, noldwds = w->nwds, cap = 0;
+	int ret = 0;
 
-		for (imi_entry_t *e = cfg->head; e; e = e->next) {
-			if (!e->key) continue;
+	w->files = NULL;
+	w->nfiles = 0;
+	w->wds = NULL;
+	w->nwds = 0;
+	w->polling = w->fd < 0;
 
-			if (strncmp(e->key, section, slen) == 0 &&
-				e->key[slen] == '.') {
+	for (int i = 0; i < 3 && !ret; i++) {
+		char path[4096];
 
-				const char *leaf_start = e->key + slen + 1;
+		resolve[i](w->progname, path, sizeof(path));
 
-				if (cnt >= cap) {
-					cap *= 2;
+		ret = __imi_watch_add(w, path, i, &cap, old, nold);
 
-					char **tmp = realloc(items, cap * sizeof(char*));
+		for (const imi_source_t *src = w->layers[i]->sources; src && !ret; src = src->next) {
+			if (src->kind == __IMI_SRC_FILE) ret = __imi_watch_add(w, src->path, i, &cap, old, nold);
+		}
+	}
 
-					if (!tmp) {
-						for (size_t i = 0; i < cnt; i++) free(items[i]);
+	for (size_t i = 0; i < nold; i++) free(old[i].path);
 
-						free(items);
+	/* Drop watches on directories nothing lives in anymore. A partial list keeps them all. */
+	for (size_t i = 0; i < noldwds; i++) {
+		size_t j = 0;
 
-						*count = 0;
+		while (j < w->nwds && w->wds[j] != oldwds[i]) j++;
 
-						return NULL;
-					}
+		if (j < w->nwds) continue;
 
-					items = tmp;
-				}
+		if (!ret) {
+			#if defined(__linux__)
+				inotify_rm_watch(w->fd, oldwds[i]);
+			#endif
+		} else {
+			int *tmp = (int *)realloc(w->wds, (w->nwds + 1) * sizeof(int));
 
-				items[cnt++] = strdup(leaf_start);
+			if (tmp) {
+				w->wds = tmp;
+				w->wds[w->nwds++] = oldwds[i];
 			}
 		}
 	}
 
-	*count = cnt;
+	free(oldwds);
+	free(old);
 
-	return items;
+	return ret;
 }
 
-static inline int inimini_hasval(const inimini_t *cfg, const char *key, const char *val) {
-	for (const imi_entry_t *e = cfg->head; e; e = e->next) {
-		if (e->key && !strcmp(e->key, key)) return !e->value || !val || !strcmp(e->value, val);
+/* Same list inimini_load() builds: layers concatenated in stack order */
+static inline inimini_t *__imi_watch_combine(inimini_watch_t *w) {
+	inimini_t *cfg = inimini_new();
+
+	for (int i = 0; cfg && i < 3; i++) {
+		for (const imi_entry_t *o = w->layers[i]->head; o; o = o->next) {
+			if (__imi_entry_stack(cfg, o, w->flags)) {
+				inimini_free(cfg);
+
+				return NULL;
+			}
+		}
 	}
 
-	return 0;
+	return cfg;
 }
 
-static inline int inimini_haskey(const inimini_t *cfg, const char *key) {
-	for (const imi_entry_t *e = cfg->head; e; e = e->next) {
-		if (e->key && !strcmp(e->key, key)) return 1;
+/* Re-stamp every file, returning the mask of layers that moved */
+static inline int __imi_watch_changed(inimini_watch_t *w) {
+	int mask = 0;
+
+	for (size_t i = 0; i < w->nfiles; i++) {
+		imi_stamp_t st;
+
+		__imi_stamp(w->files[i].path, &st);
+
+		if (memcmp(&st, &w->files[i].stamp, sizeof(st))) {
+			w->files[i].stamp = st;
+			mask |= 1 << w->files[i].layer;
+		}
 	}
 
-	return 0;
+	return mask;
 }
 
-static inline int inimini_hassec(const inimini_t *cfg, const char *sect) {
-	size_t i = 0;
+static inline void __imi_watch_sleep(int ms) {
+	#if defined(_WIN32)
+		usleep((useconds_t)ms * 1000);
+	#else
+		poll(NULL, 0, ms);
+	#endif
+}
 
-	for (const imi_entry_t *e = cfg->head; e && i < cfg->count; e = e->next, i++) {
-		if (!strcmp(e->parent, sect)) return 1;
-	}
+/* Sleep up to ms, returning 1 early when inotify reports activity (events are drained) */
+static inline int __imi_watch_wait(inimini_watch_t *w, int ms) {
+	#if defined(__linux__)
+		if (w->fd >= 0) {
+			struct pollfd p = { w->fd, POLLIN, 0 };
+			char buf[4096];
+
+			if (poll(&p, 1, ms) <= 0) return 0;
+
+			while (read(w->fd, buf, sizeof(buf)) > 0);
+
+			return 1;
+		}
+	#endif
+
+	__imi_watch_sleep(ms);
 
 	return 0;
 }
 
-static inline size_t inimini_count(const inimini_t *cfg) {
-	return cfg->count;
+static inline void inimini_watch_free(inimini_watch_t *w) {
+	if (!w) return;
+
+	for (int i = 0; i < 3; i++) inimini_free(w->layers[i]);
+	for (size_t i = 0; i < w->nfiles; i++) free(w->files[i].path);
+
+	#if defined(__linux__)
+		if (w->fd >= 0) close(w->fd);
+	#endif
+
+	inimini_free(w->cfg);
+	free(w->wds);
+	free(w->files);
+	free(w->cbs);
+	free(w->progname);
+	free(w);
 }
 
-/* ============================================================================
- * DATA MODIFICATION (SET)
- * ========================================================================== */
-static inline int inimini_setstr(inimini_t *cfg, const char *key, const char *val) {
-	for (imi_entry_t *e = cfg->head; e; e = e->next) {
-		if (!e->key) continue;
+static inline inimini_watch_t *inimini_watch_new(const char *progname, uint32_t flags) {
+	inimini_watch_t *w = (inimini_watch_t *)calloc(1, sizeof(inimini_watch_t));
 
-		if (!strcmp(e->key, key)) {
-			free(e->value);
+	if (!w) return NULL;
 
-			e->value = strdup(val);
+	w->fd = -1;
+	w->flags = flags & ~(uint32_t)(IMI_PARALLEL | IMI_MMAP);
 
-			return 0;
-		}
+	#if defined(__linux__)
+		w->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	#endif
+
+	if (!(w->progname = strdup(progname))) {
+		inimini_watch_free(w);
+
+		return NULL;
 	}
 
-	imi_entry_t *e = calloc(1, sizeof(imi_entry_t));
+	for (int i = 0; i < 3; i++) {
+		if (!(w->layers[i] = __imi_watch_parse(w, i))) {
+			inimini_watch_free(w);
 
-	if (!e) return -1;
+			return NULL;
+		}
+	}
 
-	e->key = __imi_extract_key(key);
-	e->value = strdup(val);
-	e->parent = __imi_extract_parent(key);
+	if (!(w->cfg = __imi_watch_combine(w)) || __imi_watch_files(w)) {
+		inimini_watch_free(w);
 
-	__imi_list_append(cfg, e);
+		return NULL;
+	}
 
-	return 0;
+	return w;
 }
 
-static inline int inimini_setint(inimini_t *cfg, const char *key, int val) {
-	char buf[64];
+static inline int inimini_watch_on(inimini_watch_t *w, imi_watch_fn fn, void *ctx) {
+	imi_watch_cb_t *tmp = (imi_watch_cb_t *)realloc(w->cbs, (w->ncbs + 1) * sizeof(imi_watch_cb_t));
 
-	snprintf(buf, sizeof(buf), "%d", val);
+	if (!tmp) return -1;
 
-	return inimini_setstr(cfg, key, buf);
+	w->cbs = tmp;
+	w->cbs[w->ncbs].fn = fn;
+	w->cbs[w->ncbs].ctx = ctx;
+	w->ncbs++;
+
+	return 0;
 }
 
-static inline int inimini_setdbl(inimini_t *cfg, const char *key, double val) {
-	char buf[64];
+/* Prefix subscription on the combined config, kept across changes (see inimini_subscribe) */
+static inline int inimini_watch_subscribe(inimini_watch_t *w, const char *prefix, imi_sub_fn fn, void *ctx) {
+	return __imi_subs_add(&w->cfg->subs, prefix, fn, ctx);
+}
 
-	snprintf(buf, sizeof(buf), "%.6g", val);
+/* Current combined config, replaced (and the old one freed) whenever a change is applied */
+static inline const inimini_t *inimini_watch_cfg(const inimini_watch_t *w) {
+	return w->cfg;
+}
 
-	return inimini_setstr(cfg, key, buf);
+/* inotify descriptor for an external poll loop (readable = call inimini_watch_poll), -1 if none */
+static inline int inimini_watch_fd(const inimini_watch_t *w) {
+	return w->fd;
 }
 
-static inline int inimini_setarr(inimini_t *cfg, const char *key, char **val, size_t count) {
-	char buf[4096] = "";
-	size_t off = 0;
+/* Wait up to timeout_ms (-1 = until something changes) and apply one coalesced change. Returns
+ * the number of changed keys, 0 on timeout or when edits left every value as it was, -1 when
+ * memory ran out (the previous cfg stays current). Callbacks run on the calling thread. */
+static inline int inimini_watch_poll(inimini_watch_t *w, int timeout_ms) {
+	int waited = 0, mask = 0;
 
-	for (size_t i = 0; i < count; i++) {
-		size_t len = strlen(val[i]);
+	while (!mask) {
+		int slice = timeout_ms < 0 ? IMI_WATCH_POLL : timeout_ms - waited;
 
-		if (off + len + 2 > sizeof(buf)) break;
+		if (w->polling && slice > IMI_WATCH_POLL) slice = IMI_WATCH_POLL;
 
-		off += sprintf(buf + off, "%s%s", i > 0 ? ", " : "", val[i]);
+		if (slice > 0) __imi_watch_wait(w, slice);
+
+		mask = __imi_watch_changed(w);
+		waited += slice;
+
+		if (!mask && timeout_ms >= 0 && waited >= timeout_ms) return 0;
 	}
 
-	return inimini_setstr(cfg, key, buf);
-}
+	/* Debounce: keep absorbing edits until the stamps hold still for a whole window. Plain sleeps,
+	 * as inotify also wakes for unrelated files in the watched directories. */
+	for (int more = 1; more; ) {
+		__imi_watch_sleep(IMI_WATCH_DEBOUNCE);
 
-static inline int inimini_remove(inimini_t *cfg, const char *key) {
-	imi_entry_t *prev = NULL;
+		more = __imi_watch_changed(w);
+		mask |= more;
+	}
 
-	for (imi_entry_t *e = cfg->head; e; e = e->next) {
-		if (!strcmp(e->key, key)) {
-			if (prev) prev->next = e->next;
-			else cfg->head = e->next;
+	__imi_watch_wait(w, 0);
 
-			if (e == cfg->tail) cfg->tail = prev;
+	inimini_t *fresh[3] = { NULL, NULL, NULL };
 
-			free(e->key);
-			free(e->value);
-			free(e->comment);
-			free(e->parent);
-			free(e);
+	for (int i = 0; i < 3; i++) {
+		if (!(mask & (1 << i))) continue;
 
-			return 0;
+		if (!(fresh[i] = __imi_watch_parse(w, i))) {
+			while (i--) inimini_free(fresh[i]);
+
+			return -1;
 		}
+	}
 
-		prev = e;
+	inimini_t *old[3];
+
+	for (int i = 0; i < 3; i++) {
+		old[i] = w->layers[i];
+
+		if (fresh[i]) w->layers[i] = fresh[i];
 	}
 
-	return -1;
-}
+	inimini_t *cfg = __imi_watch_combine(w);
 
-static inline int inimini_clear(inimini_t *cfg) {
-	while (cfg->head) {
-		imi_entry_t *e = cfg->head;
-		cfg->head = e->next;
+	if (!cfg) {
+		for (int i = 0; i < 3; i++) {
+			w->layers[i] = old[i];
 
-		if (cfg->head == NULL) cfg->tail = NULL;
+			inimini_free(fresh[i]);
+		}
 
-		free(e->key);
-		free(e->value);
-		free(e->comment);
-		free(e->parent);
-		free(e);
+		return -1;
 	}
 
-	cfg->count = 0;
+	for (int i = 0; i < 3; i++) {
+		if (fresh[i]) inimini_free(old[i]);
+	}
 
-	return 0;
-}
+	/* Includes may have come or gone, failure here leaves a partial list until the next change */
+	__imi_watch_files(w);
 
-static inline int inimini_comment(inimini_t *cfg, const char *key, const char *comment) {
-	for (imi_entry_t *e = cfg->head; e; e = e->next) {
-		if (!strcmp(e->key, key)) {
-			free(e->comment);
+	inimini_diff_t *d = inimini_diff(w->cfg, cfg, 0);
+	const char **keys = d && d->count ? (const char **)malloc(d->count * sizeof(char *)) : NULL;
+	size_t count = keys ? d->count : 0;
+	inimini_t *prev = w->cfg;
 
-			e->comment = strdup(comment);
+	for (size_t i = 0; i < count; i++) keys[i] = d->items[i].key;
 
-			return 0;
-		}
+	/* Subscriptions belong to the watcher and follow its cfg */
+	cfg->subs = prev->subs;
+	prev->subs = NULL;
+	w->cfg = cfg;
+
+	for (size_t i = 0; i < count; i++) __imi_notify(cfg, keys[i], inimini_getstr(cfg, keys[i], NULL));
+
+	if (count) {
+		for (size_t i = 0; i < w->ncbs; i++) w->cbs[i].fn(cfg, keys, count, w->cbs[i].ctx);
 	}
 
-	return -1;
+	free(keys);
+	inimini_diff_free(d);
+	inimini_free(prev);
+
+	return (int)count;
 }
 
 /* ============================================================================
@@ -991,13 +4989,15 @@ static inline int inimini_comment(inimini_t *cfg, const char *key, const char *c
 /*
  * MUST FREE BY CALLER:
  *   - Config structs from new/read/load/merge
- *   - Array pointers from getarr() + each element string
+ *   - The array from getsub() (not its strings)
+ *   - Diffs from inimini_diff() via inimini_diff_free()
  *   - Any new allocations explicitly documented above
  *
  * DO NOT FREE:
  *   - Strings from getters (getstr/getint/getdbl) — internal references tied to cfg lifetime
  *   - Entry comment / parent fields — freed automatically with cfg
- *   - Arrays from getarr() are cache copies — caller owns the array itself
+ *   - Arrays from getarr() — one cached block per entry, valid until the value changes
+ *   - Strings listed by getsub() — section paths and key leaves owned by cfg
  *
  * SAFETY: inimini_free() is idempotent. Safe to call on NULL or multiple times.
  */
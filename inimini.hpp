@@ -0,0 +1,200 @@
+/* ============================================================================
+ * INIMINI.HPP - Optional C++17 wrapper for inimini.h
+ *
+ * RAII owner for inimini_t plus typed getters that never allocate:
+ *   - strings come back as std::string_view into the config (valid until the key changes)
+ *   - numbers and booleans come back as std::optional, empty when missing or unconvertible
+ *   - keys wrapped in IMI_KEY() are hashed at compile time and probe the index directly
+ *
+ *   inimini::config cfg;
+ *   cfg.load("myapp", IMI_INCLUDES);
+ *
+ *   std::string_view host = cfg.get<std::string_view>("db.host").value_or("localhost");
+ *   int port = cfg.get("db.port", 5432);
+ *
+ * LICENSE: 0BSD (same as inimini.h)
+ * ========================================================================== */
+#ifndef INIMINI_HPP
+#define INIMINI_HPP
+#pragma once
+
+#include "inimini.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace inimini {
+
+/* ============================================================================
+ * KEYS
+ * ========================================================================== */
+
+/* FNV-1a 64, bit-identical to __imi_hash */
+constexpr uint64_t hash(std::string_view s) noexcept {
+	uint64_t h = 0xcbf29ce484222325ULL;
+
+	for (char c : s) {
+		h ^= (unsigned char)c;
+		h *= 0x100000001b3ULL;
+	}
+
+	return h;
+}
+
+/* Key name plus its index hash. Runtime strings hash once on construction; a constexpr key
+ * object or IMI_KEY("...") fixes the hash at compile time. The name must be NUL-terminated and
+ * outlive the call. */
+class key {
+public:
+	constexpr key(const char *s) noexcept : name_(s), hash_(s ? inimini::hash(s) : 0) {}
+
+	key(const std::string &s) noexcept : name_(s.c_str()), hash_(inimini::hash(s)) {}
+
+	/* Prehashed - hash must equal inimini::hash(s) */
+	constexpr key(const char *s, uint64_t hash, std::true_type) noexcept : name_(s), hash_(hash) {}
+
+	constexpr const char *name() const noexcept { return name_; }
+	constexpr uint64_t hash() const noexcept { return hash_; }
+
+private:
+	const char *name_;
+	uint64_t hash_;
+};
+
+}
+
+/* Literal key hashed in a constant expression: cfg.get<int>(IMI_KEY("db.port")) */
+#define IMI_KEY(s) (::inimini::key((s), std::integral_constant<uint64_t, ::inimini::hash(s)>::value, std::true_type()))
+
+namespace inimini {
+
+/* ============================================================================
+ * CONFIG
+ * Move-only owner of an inimini_t. Getters resolve keys through the hashed index and read the
+ * entry conversion cache, so repeated numeric reads skip both hashing and strtol/strtod. Filling
+ * that cache writes to the config: const getters are not safe to call from several threads.
+ * ========================================================================== */
+class config {
+public:
+	config() : cfg_(inimini_new()) {
+		if (!cfg_) throw std::bad_alloc();
+	}
+
+	/* Adopt an existing config (e.g. from inimini_merge) */
+	explicit config(inimini_t *cfg) noexcept : cfg_(cfg) {}
+
+	static config arena(size_t size_hint = 0) {
+		inimini_t *cfg = inimini_new_arena(size_hint);
+
+		if (!cfg) throw std::bad_alloc();
+
+		return config(cfg);
+	}
+
+	~config() { inimini_free(cfg_); }
+
+	config(const config &) = delete;
+	config &operator=(const config &) = delete;
+
+	config(config &&o) noexcept : cfg_(std::exchange(o.cfg_, nullptr)) {}
+
+	config &operator=(config &&o) noexcept {
+		if (this != &o) {
+			inimini_free(cfg_);
+
+			cfg_ = std::exchange(o.cfg_, nullptr);
+		}
+
+		return *this;
+	}
+
+	inimini_t *native() const noexcept { return cfg_; }
+	inimini_t *release() noexcept { return std::exchange(cfg_, nullptr); }
+	explicit operator bool() const noexcept { return cfg_ != nullptr; }
+
+	/* Loading and saving keep the C return conventions */
+	int load(const char *progname, uint32_t flags = 0) { return inimini_load(cfg_, progname, flags); }
+	int read(const char *path, uint32_t flags = 0) { return inimini_read(cfg_, path, flags); }
+	int parse(std::string_view buf, uint32_t flags = 0) { return inimini_parse_buf(cfg_, buf.data(), buf.size(), flags); }
+	int write(const char *path, uint32_t flags = 0) const { return inimini_write(cfg_, path, flags); }
+
+	imi_handle_t handle(key k) const noexcept { return inimini_handle_hashed(cfg_, k.name(), k.hash()); }
+
+	bool has(key k) const noexcept { return handle(k) != nullptr; }
+
+	/* T is std::string_view, const char *, int, int64_t, double or bool */
+	template <typename T>
+	std::optional<T> get(key k) const noexcept { return convert<T>(handle(k)); }
+
+	template <typename T>
+	T get(key k, T def) const noexcept { return get<T>(k).value_or(def); }
+
+	/* def may be nullptr as in the C getters, a missing key then reads as an empty view */
+	std::string_view get(key k, const char *def) const noexcept {
+		std::optional<std::string_view> v = get<std::string_view>(k);
+
+		return v ? *v : def ? std::string_view(def) : std::string_view();
+	}
+
+	std::string_view get(key k, std::nullptr_t) const noexcept { return get(k, (const char *)nullptr); }
+
+	/* Typed reads through a resolved handle - no lookup at all */
+	template <typename T>
+	static std::optional<T> convert(imi_handle_t h) noexcept {
+		if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, const char *>) {
+			if (!h || !h->value) return std::nullopt;
+
+			return T(h->value);
+		} else if constexpr (std::is_same_v<T, bool>) {
+			int v;
+
+			if (inimini_htrybool(h, &v) != IMI_OK) return std::nullopt;
+
+			return v != 0;
+		} else if constexpr (std::is_floating_point_v<T>) {
+			double v;
+
+			if (inimini_htrydbl(h, &v) != IMI_OK) return std::nullopt;
+
+			return static_cast<T>(v);
+		} else if constexpr (std::is_integral_v<T>) {
+			int64_t v;
+
+			if (inimini_htryint(h, &v) != IMI_OK) return std::nullopt;
+
+			if constexpr (std::is_unsigned_v<T>) {
+				if (v < 0 || (uint64_t)v > std::numeric_limits<T>::max()) return std::nullopt;
+			} else if constexpr (sizeof(T) < sizeof(int64_t)) {
+				if (v < std::numeric_limits<T>::min() || v > std::numeric_limits<T>::max()) return std::nullopt;
+			}
+
+			return static_cast<T>(v);
+		} else {
+			static_assert(std::is_void_v<T>, "inimini::config::get: unsupported type");
+		}
+	}
+
+	int set(const char *k, const char *value) { return inimini_setstr(cfg_, k, value); }
+	int set(const char *k, const std::string &value) { return inimini_setstr(cfg_, k, value.c_str()); }
+	int set(const char *k, int value) { return inimini_setint(cfg_, k, value); }
+	int set(const char *k, double value) { return inimini_setdbl(cfg_, k, value); }
+	int set(const char *k, bool value) { return inimini_setstr(cfg_, k, value ? "true" : "false"); }
+
+	int remove(const char *k) { return inimini_remove(cfg_, k); }
+
+	size_t size() const noexcept { return inimini_count(cfg_); }
+
+private:
+	inimini_t *cfg_;
+};
+
+}
+
+#endif
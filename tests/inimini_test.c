@@ -0,0 +1,300 @@
+/* ============================================================================
+ * INIMINI_TEST.C - Regression tests for inimini.h
+ *
+ *   cc -std=gnu11 -Wall -o inimini_test tests/inimini_test.c -lpthread && ./inimini_test
+ *
+ * Each test runs in a scratch directory that is also $HOME, the XDG dirs and cwd, so the load
+ * stack never sees the real user's configs.
+ * ========================================================================== */
+#include "../inimini.h"
+
+#include <assert.h>
+#include <pthread.h>
+
+static char __test_root[] = "/tmp/inimini_test.XXXXXX";
+
+static void __test_write(const char *path, const char *text) {
+	FILE *f = fopen(path, "w");
+
+	assert(f);
+
+	fputs(text, f);
+	fclose(f);
+}
+
+/* ${VAR} is expanded at parse time, so a changed variable must miss the compiled cache */
+static void test_cache_env(void) {
+	__test_write("./.tenvconf", "[data]\npath = ${IMI_TEST_DATA}/x\n");
+
+	setenv("IMI_TEST_DATA", "/one", 1);
+
+	inimini_frozen_t *snap = inimini_load_frozen("tenv", 0);
+
+	assert(snap && !strcmp(inimini_frozen_getstr(snap, "data.path", ""), "/one/x"));
+
+	inimini_frozen_free(snap);
+
+	snap = inimini_load_frozen("tenv", 0);
+
+	assert(snap && snap->mapped && !strcmp(inimini_frozen_getstr(snap, "data.path", ""), "/one/x"));
+
+	inimini_frozen_free(snap);
+
+	setenv("IMI_TEST_DATA", "/two", 1);
+
+	snap = inimini_load_frozen("tenv", 0);
+
+	assert(snap && !snap->mapped && !strcmp(inimini_frozen_getstr(snap, "data.path", ""), "/two/x"));
+
+	inimini_frozen_free(snap);
+
+	unsetenv("IMI_TEST_DATA");
+
+	snap = inimini_load_frozen("tenv", 0);
+
+	assert(snap && !snap->mapped && strcmp(inimini_frozen_getstr(snap, "data.path", ""), "/two/x"));
+
+	inimini_frozen_free(snap);
+}
+
+/* Includes that did not load still decide the result: a fragment created later, or includeIf
+ * evaluated from another repository, must miss the compiled cache */
+static void test_cache_includes(void) {
+	char path[4200];
+
+	snprintf(path, sizeof(path), "%s/.tincconf", __test_root);
+	__test_write(path, "[core]\nname = base\n[include]\npath = late.conf\n[includeIf \"gitdir:repo1/\"]\npath = repo1.conf\n");
+	snprintf(path, sizeof(path), "%s/repo1.conf", __test_root);
+	__test_write(path, "[repo]\nname = one\n");
+
+	assert(!mkdir("repo1", 0755) && !mkdir("repo1/.git", 0755) && !mkdir("repo2", 0755) && !mkdir("repo2/.git", 0755));
+
+	inimini_frozen_t *snap = inimini_load_frozen("tinc", IMI_INCLUDES);
+
+	assert(snap && !strcmp(inimini_frozen_getstr(snap, "core.name", ""), "base") && !inimini_frozen_getstr(snap, "late.v", NULL));
+
+	inimini_frozen_free(snap);
+
+	snprintf(path, sizeof(path), "%s/late.conf", __test_root);
+	__test_write(path, "[late]\nv = 1\n");
+
+	snap = inimini_load_frozen("tinc", IMI_INCLUDES);
+
+	assert(snap && !snap->mapped && !strcmp(inimini_frozen_getstr(snap, "late.v", ""), "1"));
+
+	inimini_frozen_free(snap);
+
+	assert(!chdir("repo1"));
+
+	snap = inimini_load_frozen("tinc", IMI_INCLUDES);
+
+	assert(snap && !snap->mapped && !strcmp(inimini_frozen_getstr(snap, "repo.name", ""), "one"));
+
+	inimini_frozen_free(snap);
+
+	assert(!chdir("../repo2"));
+
+	snap = inimini_load_frozen("tinc", IMI_INCLUDES);
+
+	assert(snap && !snap->mapped && !inimini_frozen_getstr(snap, "repo.name", NULL));
+
+	inimini_frozen_free(snap);
+
+	assert(!chdir(__test_root));
+}
+
+/* A damaged cache file is rebuilt, never read out of bounds */
+static void test_cache_corrupt(void) {
+	char path[4200];
+
+	__test_write("./.tbadconf", "[a]\nk = 1\nlist = x, y, z\n[b]\nk = two\n");
+
+	inimini_frozen_free(inimini_load_frozen("tbad", 0));
+
+	snprintf(path, sizeof(path), "%s/tbad.%s.%s", __test_root, IMI_SUFFIXED, IMI_CACHE_SUFFIX);
+
+	FILE *f = fopen(path, "rb");
+
+	assert(f);
+
+	unsigned char good[4096];
+	size_t len = fread(good, 1, sizeof(good), f);
+
+	fclose(f);
+
+	assert(len > sizeof(imi_frozen_hdr_t) && len < sizeof(good));
+
+	for (size_t i = 0; i < len * 2; i++) {
+		unsigned char bad[4096];
+
+		memcpy(bad, good, len);
+
+		/* First pass flips one byte, second truncates */
+		if (i < len) bad[i] ^= 0xa5;
+
+		f = fopen(path, "wb");
+
+		assert(f);
+
+		fwrite(bad, 1, i < len ? len : i - len, f);
+		fclose(f);
+
+		inimini_frozen_t *snap = inimini_load_frozen("tbad", 0);
+		const char *arr[4];
+
+		assert(snap);
+
+		inimini_frozen_getstr(snap, "a.k", NULL);
+		inimini_frozen_getstr(snap, "missing.key", NULL);
+		inimini_frozen_getarr(snap, "a.list", arr, 4);
+
+		inimini_frozen_free(snap);
+	}
+}
+
+/* Appends a key every 20 ms - inside the debounce window - while unrelated files churn */
+static void *__test_slow_save(void *arg) {
+	(void)arg;
+
+	FILE *f = fopen("./.twconf", "a");
+
+	for (int i = 0; i < 10; i++) {
+		fprintf(f, "k%d = %d\n", i, i);
+		fflush(f);
+
+		for (int j = 0; j < 10; j++) {
+			__test_write("./noise", "x");
+
+			poll(NULL, 0, 2);
+		}
+	}
+
+	fclose(f);
+
+	return NULL;
+}
+
+/* Activity next to a watched file must not cut the debounce window short */
+static void test_watch_debounce(void) {
+	pthread_t tid;
+
+	__test_write("./.twconf", "[w]\n");
+
+	inimini_watch_t *w = inimini_watch_new("tw", 0);
+
+	assert(w && !pthread_create(&tid, NULL, __test_slow_save, NULL));
+
+	assert(inimini_watch_poll(w, 2000) == 10);
+	assert(!pthread_join(tid, NULL));
+	assert(!strcmp(inimini_getstr(inimini_watch_cfg(w), "w.k9", ""), "9"));
+
+	inimini_watch_free(w);
+}
+
+/* Directories that no longer hold a watched file lose their inotify watch */
+static void test_watch_dirs(void) {
+	assert(!mkdir("twinc", 0755));
+
+	__test_write("./twinc/extra.conf", "[x]\nv = 1\n");
+	__test_write("./.twdconf", "[include]\npath = twinc/extra.conf\n");
+
+	inimini_watch_t *w = inimini_watch_new("twd", IMI_INCLUDES);
+
+	assert(w && !strcmp(inimini_getstr(inimini_watch_cfg(w), "x.v", ""), "1"));
+
+	size_t before = w->nwds;
+
+	__test_write("./.twdconf", "[y]\nv = 2\n");
+
+	assert(inimini_watch_poll(w, 2000) > 0);
+	assert(!inimini_getstr(inimini_watch_cfg(w), "x.v", NULL));
+
+	#if defined(__linux__)
+		assert(w->fd < 0 || w->nwds == before - 1);
+	#endif
+
+	(void)before;
+
+	inimini_watch_free(w);
+}
+
+/* Values of a loaded config survive the file being truncated under it */
+static void test_read_truncated(void) {
+	FILE *f = fopen("./.ttrconf", "w");
+
+	assert(f);
+
+	fputs("[s]\n", f);
+
+	for (int i = 0; i < 2000; i++) fprintf(f, "k%d = value%d\n", i, i);
+
+	fclose(f);
+
+	inimini_t *cfg = inimini_new();
+
+	assert(inimini_load(cfg, "ttr", 0) >= 1);
+	assert(!truncate("./.ttrconf", 0));
+	assert(!strcmp(inimini_getstr(cfg, "s.k1999", ""), "value1999"));
+
+	inimini_free(cfg);
+}
+
+static char __test_seen[8][64];
+static int __test_nseen;
+
+static void __test_on_change(const char *key, const char *value, void *ctx) {
+	(void)ctx;
+
+	if (__test_nseen < 8) snprintf(__test_seen[__test_nseen++], 64, "%s=%s", key, value ? value : "(null)");
+}
+
+/* An upsert re-read reports changed keys and the keys it adds, not only the ones it replaces */
+static void test_subscribe_added(void) {
+	inimini_t *cfg = inimini_new();
+
+	__test_write("./sub.conf", "[net]\nport = 1\n");
+
+	assert(!inimini_read(cfg, "./sub.conf", IMI_UPSERT));
+	assert(!inimini_subscribe(cfg, "net.", __test_on_change, NULL));
+
+	__test_write("./sub.conf", "[net]\nport = 2\nhost = example\nport = 3\n");
+
+	assert(!inimini_read(cfg, "./sub.conf", IMI_UPSERT));
+
+	assert(__test_nseen == 3);
+	assert(!strcmp(__test_seen[0], "net.port=2"));
+	assert(!strcmp(__test_seen[1], "net.host=example"));
+	assert(!strcmp(__test_seen[2], "net.port=3"));
+
+	/* Without IMI_UPSERT a repeated key stays shadowed: only the new one is heard */
+	__test_nseen = 0;
+
+	__test_write("./sub.conf", "[net]\nport = 9\nuser = me\n");
+
+	assert(!inimini_read(cfg, "./sub.conf", 0));
+	assert(__test_nseen == 1 && !strcmp(__test_seen[0], "net.user=me"));
+
+	inimini_free(cfg);
+}
+
+int main(void) {
+	assert(mkdtemp(__test_root) && !chdir(__test_root));
+
+	setenv("HOME", __test_root, 1);
+	setenv("XDG_CONFIG_HOME", __test_root, 1);
+	setenv("XDG_CACHE_HOME", __test_root, 1);
+
+	test_cache_env();
+	test_cache_includes();
+	test_cache_corrupt();
+	test_watch_debounce();
+	test_watch_dirs();
+	test_subscribe_added();
+	test_read_truncated();
+
+	inimini_include_flush();
+
+	puts("ok");
+
+	return 0;
+}